@@ -23,22 +23,28 @@ License if public*/
 
 #include "amoled.h"
 #include "amoled_qspi_bus.h"
+#include "amoled_record_bus.h"
 
 #include "py/obj.h"
 #include "py/runtime.h"
 #include "mphalport.h"
 #include "py/gc.h"
 #include "py/objstr.h"
+#include "py/objlist.h"
 
 #include "esp_lcd_panel_io.h"
 #include "driver/spi_master.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/gpio.h"
 
 #include "mpfile/mpfile.h"
 #include "jpg/tjpgd565.h"
 
 #include <string.h>
 #include <math.h>
-#include <wchar.h>
 
 #define AMOLED_DRIVER_VERSION "26.07.2025"
 
@@ -51,7 +57,18 @@ License if public*/
 #define ABS(N) (((N) < 0) ? (-(N)) : (N))
 #define mp_hal_delay_ms(delay) (mp_hal_delay_us(delay * 1000))
 
-#define MAX_POLY_CORNERS 32
+// Cost of one more memory write transaction (command, CS toggle, polling) expressed in copied bytes
+// Windows with rows longer than this are sent row by row from the frame buffer instead of being copied
+#define ROW_TX_OVERHEAD_BYTES 512
+
+// The flush worker runs on the core Micropython does not use
+#ifdef MP_TASK_COREID
+#define FLUSH_WORKER_CORE (1 - MP_TASK_COREID)
+#else
+#define FLUSH_WORKER_CORE 1
+#endif
+
+#define TE_TIMEOUT_MS 50    // Default wait for the TE edge, a bit more than two frames at 60 Hz
 
 //#define MAX_BUFFER_SIZE_IN_PIXEL  4800 // 600 * 8 = 4800
 
@@ -86,11 +103,12 @@ STATIC const amoled_rotation_t ORIENTATIONS_RM67162[4] = {
     { RM67162_MADCTL_MV | RM67162_MADCTL_MY | RM67162_MADCTL_RGB, 536, 240, 0, 0}
 };
 
+// 90 and 270 degrees : the driver exchanges rows and columns, the panel flips do the rest
 STATIC const amoled_rotation_t ORIENTATIONS_SH8601[4] = {
     { SH8601_MADCTL_RGB, 												368, 448, 0, 0},
-    { SH8601_MADCTL_X_FLIP | SH8601_MADCTL_RGB, 						368, 448, 0, 0},
-    { SH8601_MADCTL_Y_FLIP | SH8601_MADCTL_RGB, 						368, 448, 0, 0},
-    { SH8601_MADCTL_X_FLIP | SH8601_MADCTL_Y_FLIP | SH8601_MADCTL_RGB, 	368, 448, 0, 0}
+    { SH8601_MADCTL_SW_MV | SH8601_MADCTL_X_FLIP | SH8601_MADCTL_RGB, 	448, 368, 0, 0},
+    { SH8601_MADCTL_X_FLIP | SH8601_MADCTL_Y_FLIP | SH8601_MADCTL_RGB, 	368, 448, 0, 0},
+    { SH8601_MADCTL_SW_MV | SH8601_MADCTL_Y_FLIP | SH8601_MADCTL_RGB, 	448, 368, 0, 0}
 };
 
 int mod(int x, int m) {
@@ -113,16 +131,98 @@ Below are transmission related functions.
 // send a buffer to the panel display memory using the panel tx_color
 STATIC void write_color(amoled_AMOLED_obj_t *self, const void *buf, int len) {
     if (self->lcd_panel_p) {
+            AMOLED_STATS_START(start);
             self->lcd_panel_p->tx_color(self->bus_obj, 0, buf, len);
+            AMOLED_STATS_ADD(&self->stats, transactions, 1);
+            AMOLED_STATS_ADD(&self->stats, pixel_bytes, len);
+            AMOLED_STATS_STOP(&self->stats, tx_us, start);
     } else {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
     }
 }
 
+// The send path below runs on the flush worker too : it never calls the Micropython runtime
+// and counts into the stats it is given, the ones of the object are only touched by Micropython
+#if AMOLED_STATS
+#define SELF_STATS(self)    (&(self)->stats)
+#define COUNTERS_STATS(c)   (&(c)->stats)
+#else
+#define SELF_STATS(self)    (NULL)
+#define COUNTERS_STATS(c)   (NULL)
+#endif
+
+// send a part of a window to the panel display memory, only queued if async_refresh is set
+// cmd is LCD_CMD_RAMWR for the first part of a window and LCD_CMD_RAMWRC for the next ones
+// returns the bus fence to wait for before buf can be modified (0 when sent synchronously)
+STATIC uint32_t send_color(amoled_AMOLED_obj_t *self, amoled_stats_t *stats, int cmd, const void *buf, int len) {
+    uint32_t fence = 0;
+    AMOLED_STATS_START(start);
+    if (self->async_refresh) {
+        fence = self->lcd_panel_p->tx_color_async(self->bus_obj, cmd, buf, len);
+    } else {
+        self->lcd_panel_p->tx_color(self->bus_obj, cmd, buf, len);
+    }
+    AMOLED_STATS_ADD(stats, transactions, 1);
+    AMOLED_STATS_ADD(stats, pixel_bytes, len);
+    AMOLED_STATS_STOP(stats, tx_us, start);
+    return fence;
+}
+
+// wait for the queued transfers up to fence (0 waits for all of them)
+STATIC void wait_panel(amoled_AMOLED_obj_t *self, amoled_stats_t *stats, uint32_t fence) {
+    if (self->async_refresh) {
+        AMOLED_STATS_START(start);
+        self->lcd_panel_p->wait(self->bus_obj, fence);
+        AMOLED_STATS_ADD(stats, queue_waits, 1);
+        AMOLED_STATS_STOP(stats, tx_us, start);
+    }
+}
+
+// add the counters of a refresh to the object ones
+STATIC void counters_merge(amoled_AMOLED_obj_t *self, const amoled_worker_counters_t *counters) {
+#if AMOLED_STATS
+    amoled_stats_merge(&self->stats, &counters->stats);
+#endif
+    self->damage.windows += counters->windows;
+    self->damage.bytes_sent += counters->bytes_sent;
+}
+
+// take over the counters of what the flush worker sent so far
+STATIC void counters_collect(amoled_AMOLED_obj_t *self) {
+    if (self->worker) {
+        amoled_worker_counters_t counters;
+        memset(&counters, 0, sizeof(counters));
+        amoled_worker_collect(self->worker, &counters);
+        counters_merge(self, &counters);
+    }
+}
+
+// wait until everything refresh sent is out : flush worker queue and async bus transfers
+STATIC void flush_sync(amoled_AMOLED_obj_t *self) {
+    if (self->worker) {
+        amoled_worker_drain(self->worker);
+        counters_collect(self);
+    }
+    wait_panel(self, SELF_STATS(self), 0);
+}
+
+// send a buffer to the panel IC register, no Micropython call so the flush worker can use it
+STATIC void tx_param(amoled_AMOLED_obj_t *self, amoled_stats_t *stats, int cmd, const void *buf, int len) {
+    AMOLED_STATS_START(start);
+    self->lcd_panel_p->tx_param(self->bus_obj, cmd, buf, len);
+    AMOLED_STATS_ADD(stats, commands, 1);
+    AMOLED_STATS_ADD(stats, param_bytes, len);
+    AMOLED_STATS_STOP(stats, tx_us, start);
+}
+
 // send a buffer to the panel IC register using the panel tx_color
+// the flush worker owns the bus while it sends : commands wait for it
 STATIC void write_spi(amoled_AMOLED_obj_t *self, int cmd, const void *buf, int len) {
     if (self->lcd_panel_p) {
-            self->lcd_panel_p->tx_param(self->bus_obj, cmd, buf, len);
+            if (self->worker) {
+                amoled_worker_drain(self->worker);
+            }
+            tx_param(self, SELF_STATS(self), cmd, buf, len);
     } else {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
     }
@@ -140,11 +240,366 @@ STATIC void frame_buffer_alloc(amoled_AMOLED_obj_t *self, int len) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate Frame Buffer."));
     }
     memset(self->frame_buffer, 0, self->frame_buffer_size);
+    AMOLED_STATS_ADD(&self->stats, allocations, 1);
+    // PSRAM frame buffers would be copied to a bounce buffer by the SPI driver on every transfer
+    self->fb_dma_capable = esp_ptr_dma_capable(self->frame_buffer);
+}
+
+STATIC void flush_worker_job(void *ctx, const amoled_area_t *area, amoled_worker_counters_t *counters);
+STATIC uint16_t colorRGB(uint8_t r, uint8_t g, uint8_t b);
+
+// 4 bits frame buffers start with the 16 colors of the CGA palette
+STATIC const uint8_t PALETTE_16[16][3] = {
+    {   0,   0,   0 }, {   0,   0, 170 }, {   0, 170,   0 }, {   0, 170, 170 },
+    { 170,   0,   0 }, { 170,   0, 170 }, { 170,  85,   0 }, { 170, 170, 170 },
+    {  85,  85,  85 }, {  85,  85, 255 }, {  85, 255,  85 }, {  85, 255, 255 },
+    { 255,  85,  85 }, { 255,  85, 255 }, { 255, 255,  85 }, { 255, 255, 255 }
+};
+
+// Default palette : BLACK and WHITE in 1 bit, CGA colors in 4 bits, index RRRGGGBB in 8 bits
+STATIC void palette_reset(amoled_AMOLED_obj_t *self) {
+    memset(self->lut, 0, sizeof(self->lut));
+    if (self->pixel_bits == 1) {
+        self->lut[0] = BLACK;
+        self->lut[1] = WHITE;
+    } else if (self->pixel_bits == 4) {
+        for (uint8_t i = 0; i < 16; i++) {
+            self->lut[i] = colorRGB(PALETTE_16[i][0], PALETTE_16[i][1], PALETTE_16[i][2]);
+        }
+    } else {
+        for (int i = 0; i < 256; i++) {
+            self->lut[i] = colorRGB(((i >> 5) & 7) * 255 / 7, ((i >> 2) & 7) * 255 / 7, (i & 3) * 255 / 3);
+        }
+    }
+}
+
+// The staging pool is allocated once, in internal DMA capable memory when available
+STATIC void staging_alloc(amoled_AMOLED_obj_t *self, size_t size) {
+    self->staging_size = size;
+    self->staging_idx = 0;
+    self->staging_gc = 0;
+    for (uint8_t i = 0; i < AMOLED_STAGING_BUFFERS; i++) {
+        self->staging[i] = heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (self->staging[i] == NULL) {
+            self->staging[i] = m_malloc(size);
+            self->staging_gc |= (1 << i);
+        }
+        if (self->staging[i] == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate staging buffers."));
+        }
+        AMOLED_STATS_ADD(&self->stats, allocations, 1);
+    }
+}
+
+// heap_only frees the buffers the GC does not own, from the finaliser
+STATIC void staging_free(amoled_AMOLED_obj_t *self, bool heap_only) {
+    for (uint8_t i = 0; i < AMOLED_STAGING_BUFFERS; i++) {
+        if (self->staging[i] == NULL) {
+            continue;
+        }
+        if (self->staging_gc & (1 << i)) {
+            if (heap_only) {
+                continue;
+            }
+            m_free(self->staging[i]);
+        } else {
+            heap_caps_free(self->staging[i]);
+        }
+        self->staging[i] = NULL;
+    }
+}
+
+// TE pin interrupt : count the edges and average the panel refresh period
+STATIC void IRAM_ATTR te_isr_handler(void *arg) {
+    amoled_AMOLED_obj_t *self = (amoled_AMOLED_obj_t *)arg;
+    int64_t now = esp_timer_get_time();
+
+    if (self->te_count) {
+        uint32_t period = (uint32_t)(now - self->te_last_us);
+        self->te_period_us = (self->te_period_us) ? ((self->te_period_us * 7) + period) / 8 : period;
+    }
+    self->te_last_us = now;
+    self->te_count++;
+}
+
+STATIC void te_init(amoled_AMOLED_obj_t *self) {
+    self->te_count = 0;
+    self->te_period_us = 0;
+    if (self->te == MP_OBJ_NULL) {
+        return;
+    }
+    mp_hal_pin_obj_t te_pin = mp_hal_get_pin_obj(self->te);
+    mp_hal_pin_input(te_pin);
+    gpio_set_intr_type(te_pin, GPIO_INTR_POSEDGE);
+    esp_err_t ret = gpio_install_isr_service(0);    // already installed if machine.Pin irq are used
+    if ((ret != ESP_OK) && (ret != ESP_ERR_INVALID_STATE)) {
+        mp_raise_msg_varg(&mp_type_OSError, MP_ERROR_TEXT("%d(gpio_install_isr_service)"), ret);
+    }
+    gpio_isr_handler_add(te_pin, te_isr_handler, self);
+    self->te_pin = te_pin;          // the handler is installed, te_deinit removes it
+    gpio_intr_enable(te_pin);
+}
+
+// Called by deinit() and the finaliser : the handler writes into self, it must not outlive it
+STATIC void te_deinit(amoled_AMOLED_obj_t *self) {
+    if (self->te_pin >= 0) {
+        gpio_intr_disable(self->te_pin);
+        gpio_isr_handler_remove(self->te_pin);
+        self->te_pin = -1;
+    }
+    self->te = MP_OBJ_NULL;
+}
+
+// Wait for the next TE rising edge, returns false on timeout or without TE pin
+// This is a busy wait : yielding would cost a whole RTOS tick, far more than the TE precision needed.
+// Pending events are still handled, so that Ctrl-C ends a long wait
+STATIC bool te_wait(amoled_AMOLED_obj_t *self, mp_int_t timeout_ms) {
+    if (self->te == MP_OBJ_NULL) {
+        return false;
+    }
+    uint32_t count = self->te_count;
+    int64_t timeout_us = (int64_t)timeout_ms * 1000;
+    int64_t start = esp_timer_get_time();
+    while (self->te_count == count) {
+        if ((esp_timer_get_time() - start) >= timeout_us) {
+            return false;
+        }
+        mp_handle_pending(true);
+    }
+    return true;
+}
+
+// Bytes used by n pixels of the frame buffer (n EVEN in 4 bits mode, multiple of 8 in 1 bit mode)
+STATIC inline size_t fb_bytes(amoled_AMOLED_obj_t *self, size_t n) {
+	return n * self->pixel_bits / 8;
+}
+
+// Address of the frame buffer pixel idx (byte holding it in 4 and 1 bit modes)
+STATIC inline uint8_t *fb_addr(amoled_AMOLED_obj_t *self, size_t idx) {
+	return (uint8_t *)self->frame_buffer + fb_bytes(self, idx);
+}
+
+// Address of the pixel idx in the frame sent to the display
+STATIC inline uint8_t *front_addr(amoled_AMOLED_obj_t *self, size_t idx) {
+	return (uint8_t *)self->front + fb_bytes(self, idx);
+}
+
+// Record frame buffer rows (not logical ones) as damaged
+// Double buffered, the flush worker only reads the front frame : drawing never waits for it
+STATIC void damage_rows(amoled_AMOLED_obj_t *self, int x, int y, int w, int h) {
+	if (self->worker && !self->double_buffer) {
+		amoled_area_t area;
+		if (amoled_damage_align(&area, x, y, w, h, self->width, self->height)) {
+			amoled_worker_fence(self->worker, &area);
+		}
+	}
+	amoled_damage_add(&self->damage, x, y, w, h, self->width, self->height);
+}
+
+// Record a frame buffer area as damaged, it will be sent on the next flush
+// While recording a display list the area also grows the bounding box of the command being recorded
+// With the flush worker it must be called before writing : it waits while the area is being sent
+// x, y, w, h are logical coordinates : a scroll region splits them in up to four frame buffer bands
+STATIC void invalidate(amoled_AMOLED_obj_t *self, int x, int y, int w, int h) {
+	if (self->dlist.drawing) {
+		amoled_area_t area;
+		if (amoled_damage_align(&area, x, y, w, h, self->width, self->height)) {
+			amoled_dlist_extend(&self->dlist, &area);
+		}
+	}
+	if (self->screen.scroll_rows == 0) {
+		damage_rows(self, x, y, w, h);
+		return;
+	}
+
+	int top = self->screen.scroll_top;
+	int bottom = top + self->screen.scroll_rows;
+	int y1 = y + h;
+
+	if (y < top) {
+		damage_rows(self, x, y, w, ((y1 < top) ? y1 : top) - y);
+	}
+	if (y1 > bottom) {
+		int y0 = (y > bottom) ? y : bottom;
+		damage_rows(self, x, y0, w, y1 - y0);
+	}
+	int s0 = (y > top) ? y : top;
+	int s1 = (y1 < bottom) ? y1 : bottom;
+	if (s0 < s1) {
+		// the rows wrap once at the end of the region
+		int p0 = amoled_surface_row(&self->screen, s0);
+		int rows = s1 - s0;
+		int first = ((bottom - p0) < rows) ? (bottom - p0) : rows;
+		damage_rows(self, x, p0, w, first);
+		if (rows > first) {
+			damage_rows(self, x, top, w, rows - first);
+		}
+	}
+}
+
+// Damage hook of the screen surface, the rendering core calls it before writing the frame buffer
+STATIC void screen_damage(void *ctx, int x, int y, int w, int h) {
+	invalidate((amoled_AMOLED_obj_t *)ctx, x, y, w, h);
+}
+
+// Clip region back to the whole screen
+STATIC void clip_reset(amoled_AMOLED_obj_t *self) {
+	amoled_surface_clip_reset(&self->screen);
+}
+
+// Describe the frame buffer as a render target again after it was swapped, reallocated or rotated
+STATIC void screen_sync(amoled_AMOLED_obj_t *self) {
+	self->screen.pixels = self->frame_buffer;
+	self->screen.width = self->width;
+	self->screen.height = self->height;
+	self->screen.pixel_bits = self->pixel_bits;
+}
+
+// Display list primitives, index of dlist_ops[]
+enum {
+	DL_PIXEL = 0,
+	DL_FILL,
+	DL_HLINE,
+	DL_VLINE,
+	DL_LINE,
+	DL_RECT,
+	DL_FILL_RECT,
+	DL_TRIAN,
+	DL_FILL_TRIAN,
+	DL_BUBBLE_RECT,
+	DL_FILL_BUBBLE_RECT,
+	DL_CIRCLE,
+	DL_FILL_CIRCLE,
+	DL_POLYGON,
+	DL_FILL_POLYGON,
+	DL_TEXT,
+	DL_WRITE,
+	DL_DRAW,
+	DL_JPG,
+	DL_BLIT,
+	DL_OPS
+};
+
+STATIC const mp_obj_t dlist_ops[DL_OPS];
+
+// While recording, append a drawing call to the display list and draw it, arguments are kept as given
+// (objects by reference). Returns what the call returned, MP_OBJ_NULL when the caller has to draw.
+// The command is dropped if drawing raises : it would raise again on every replay()
+STATIC mp_obj_t dlist_record(amoled_AMOLED_obj_t *self, uint8_t op, size_t n_args, const mp_obj_t *args) {
+	amoled_dlist_t *dl = &self->dlist;
+
+	// drawing into a Surface does not change the screen the display list redraws
+	if (!dl->recording || dl->drawing || (self->target != &self->screen)) {
+		return MP_OBJ_NULL;
+	}
+	mp_obj_list_t *objs = MP_OBJ_TO_PTR(self->dlist_objs);
+	size_t objs_len = objs->len;
+	uint8_t nargs = n_args - 1;
+	amoled_dl_cmd_t *cmd = amoled_dlist_append(dl, op, nargs);
+	if (cmd == NULL) {
+		size_t cap = (dl->cap) ? dl->cap * 2 : 1024;
+		dl->buf = m_renew(uint8_t, dl->buf, dl->cap, cap);
+		dl->cap = cap;
+		AMOLED_STATS_ADD(&self->stats, allocations, 1);
+		cmd = amoled_dlist_append(dl, op, nargs);
+	}
+	for (uint8_t i = 0; i < nargs; i++) {
+		mp_obj_t arg = args[i + 1];
+		if (mp_obj_is_small_int(arg) && (MP_OBJ_SMALL_INT_VALUE(arg) >= INT32_MIN) && (MP_OBJ_SMALL_INT_VALUE(arg) <= INT32_MAX)) {
+			cmd->args[i] = MP_OBJ_SMALL_INT_VALUE(arg);
+		} else {
+			size_t len;
+			mp_obj_t *items;
+			mp_obj_list_get(self->dlist_objs, &len, &items);
+			cmd->objs |= (1 << i);
+			cmd->args[i] = len;
+			mp_obj_list_append(self->dlist_objs, arg);
+		}
+	}
+
+	mp_obj_t ret;
+	nlr_buf_t nlr;
+	dl->drawing = true;
+	if (nlr_push(&nlr) == 0) {
+		ret = mp_call_function_n_kw(dlist_ops[op], n_args, 0, args);
+		nlr_pop();
+	} else {
+		dl->drawing = false;
+		amoled_dlist_drop_last(dl);
+		while (objs->len > objs_len) {
+			objs->items[--objs->len] = MP_OBJ_NULL;
+		}
+		nlr_jump(nlr.ret_val);
+	}
+	dl->drawing = false;
+	return ret;
+}
+
+// Write the panel vertical scroll start matching the ring offset
+STATIC void scroll_write_start(amoled_AMOLED_obj_t *self) {
+	self->scroll_pending = false;
+	int vsp = self->screen.scroll_top + self->y_gap + self->screen.scroll_offset;
+	write_spi(self, LCD_CMD_VSCSAD, (uint8_t []) { vsp >> 8, vsp & 0xFF }, 2);
+}
+
+STATIC void fb_reverse_rows(amoled_AMOLED_obj_t *self, int first, int last, uint16_t *tmp) {
+	size_t row_size = fb_bytes(self, self->width);
+	while (first < last) {
+		memcpy(tmp, fb_addr(self, first * self->width), row_size);
+		memcpy(fb_addr(self, first * self->width), fb_addr(self, last * self->width), row_size);
+		memcpy(fb_addr(self, last * self->width), tmp, row_size);
+		first++;
+		last--;
+	}
+}
+
+// Put the scroll region rows back in logical order and stop the ring addressing
+STATIC void scroll_reset(amoled_AMOLED_obj_t *self) {
+	if (self->screen.scroll_rows == 0) {
+		return;
+	}
+	if (self->screen.scroll_offset) {
+		int top = self->screen.scroll_top;
+		int end = top + self->screen.scroll_rows - 1;
+		int off = self->screen.scroll_offset;
+
+		flush_sync(self);		// a staging buffer is borrowed as row buffer
+		// rotate the region left by the offset, three reversals need a single row buffer
+		fb_reverse_rows(self, top, top + off - 1, self->staging[0]);
+		fb_reverse_rows(self, top + off, end, self->staging[0]);
+		fb_reverse_rows(self, top, end, self->staging[0]);
+		damage_rows(self, 0, top, self->width, self->screen.scroll_rows);
+		self->screen.scroll_offset = 0;
+		scroll_write_start(self);
+	}
+	self->screen.scroll_rows = 0;
+}
+
+// Panel vertical scroll moves memory rows : frame buffer rows must be memory rows in the same order
+STATIC bool scroll_supported(amoled_AMOLED_obj_t *self) {
+	if (self->transpose || (self->madctl_val & (LCD_CMD_MV_BIT | LCD_CMD_MY_BIT))) {
+		return false;
+	}
+	// rows are moved in bytes
+	if ((self->pixel_bits == 1) && (self->width & 7)) {
+		return false;
+	}
+	// the SH8601 flips the rows with bit 0 of its Y_FLIP value
+	return !((self->type == 2) && (self->madctl_val & SH8601_MADCTL_Y_FLIP & ~LCD_CMD_MH_BIT));
 }
 
 STATIC void set_rotation(amoled_AMOLED_obj_t *self, uint8_t rotation) {
+    scroll_reset(self);     // the ring is laid out with the previous width
+    uint8_t madctl = self->rotations[rotation].madctl;
+
+    // wait for the areas sent in the previous orientation before changing the windows layout
+    flush_sync(self);
+    self->transpose = (self->type == 2) && (madctl & SH8601_MADCTL_SW_MV);
+    if (self->transpose) {
+        madctl &= ~SH8601_MADCTL_SW_MV;
+    }
     self->madctl_val &= 0x1F;
-    self->madctl_val |= self->rotations[rotation].madctl;
+    self->madctl_val |= madctl;
 
     write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) { self->madctl_val }, 1);
 
@@ -154,6 +609,23 @@ STATIC void set_rotation(amoled_AMOLED_obj_t *self, uint8_t rotation) {
     self->max_height_value = self->height - 1;
     self->x_gap = self->rotations[rotation].colstart;
     self->y_gap = self->rotations[rotation].rowstart;
+
+    screen_sync(self);
+    clip_reset(self);
+
+    // The sprites save-under have the previous layout : they are dropped, their pixels stay drawn
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_list_get(self->sprites, &len, &items);
+    for (size_t i = 0; i < len; i++) {
+        ((amoled_sprite_obj_t *)MP_OBJ_TO_PTR(items[i]))->shown = false;
+    }
+    self->sprites = mp_obj_new_list(0, NULL);
+
+    // Pending areas belong to the previous orientation, the whole panel has to be rewritten
+    amoled_damage_clear(&self->damage);
+    invalidate(self, 0, 0, self->width, self->height);
+    self->shadow_valid = false;
 }
 
 STATIC void amoled_AMOLED_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t  kind) {
@@ -178,7 +650,12 @@ mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t
         ARG_reset_level,
         ARG_color_space,
         ARG_bpp,
-        ARG_auto_refresh
+        ARG_auto_refresh,
+        ARG_staging_size,
+        ARG_async_refresh,
+        ARG_te,
+        ARG_flush_worker,
+        ARG_double_buffer
     };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bus,               MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}     },
@@ -188,6 +665,11 @@ mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t
         { MP_QSTR_color_space,       MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = COLOR_SPACE_RGB} },
         { MP_QSTR_bpp,               MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 16}              },
 		{ MP_QSTR_auto_refresh,		 MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = true}          },
+        { MP_QSTR_staging_size,      MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = AMOLED_STAGING_SIZE} },
+        { MP_QSTR_async_refresh,     MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}          },
+        { MP_QSTR_te,                MP_ARG_OBJ | MP_ARG_KW_ONLY,  {.u_obj = MP_OBJ_NULL}     },
+        { MP_QSTR_flush_worker,      MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}          },
+        { MP_QSTR_double_buffer,     MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}          },
     };
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all_kw_array(
@@ -199,58 +681,75 @@ mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t
         args
     );
 
-    // create new object
-    amoled_AMOLED_obj_t *self = m_new_obj(amoled_AMOLED_obj_t);
+    // create new object : its finaliser releases the TE interrupt, the flush worker and the DMA staging
+    // buffers, so a failed construction or an object dropped without deinit() does not leave them behind
+    amoled_AMOLED_obj_t *self = m_new_obj_with_finaliser(amoled_AMOLED_obj_t);
     self->base.type = &amoled_AMOLED_type;
+    self->te = MP_OBJ_NULL;
+    self->te_pin = -1;
+    memset(self->staging, 0, sizeof(self->staging));
+    self->worker = NULL;
 
     self->bus_obj = (mp_obj_base_t *)MP_OBJ_TO_PTR(args[ARG_bus].u_obj);
 #ifdef MP_OBJ_TYPE_GET_SLOT
-    self->lcd_panel_p = (amoled_panel_p_t *)MP_OBJ_TYPE_GET_SLOT(self->bus_obj->type, protocol);
+    self->lcd_panel_p = (amoled_panel_p_t *)MP_OBJ_TYPE_GET_SLOT_OR_NULL(self->bus_obj->type, protocol);
 #else
     self->lcd_panel_p = (amoled_panel_p_t *)self->bus_obj->type->protocol;
 #endif
+    // checked once : the send path also runs on the flush worker, which cannot raise
+    if (self->lcd_panel_p == NULL) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
+    }
 
 	//Display type 0 = TDisplay S3 RM61672 / 1 = T4-S3 RM690B0 / 2 = WAVESHARE SH8601
 	self->type = args[ARG_type].u_int;
 
     // self->max_width_value etc will be initialized in the rotation later.
-    self->width = ((amoled_qspi_bus_obj_t *)self->bus_obj)->width;
-    self->height = ((amoled_qspi_bus_obj_t *)self->bus_obj)->height;
+    self->width = ((amoled_panel_bus_obj_t *)self->bus_obj)->width;
+    self->height = ((amoled_panel_bus_obj_t *)self->bus_obj)->height;
 	
 	self->auto_refresh = args[ARG_auto_refresh].u_bool;
+	self->async_refresh = args[ARG_async_refresh].u_bool;
+	if (self->async_refresh && (self->lcd_panel_p->tx_color_async == NULL)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("async_refresh not supported by this bus"));
+	}
+	if (self->async_refresh && args[ARG_flush_worker].u_bool) {
+		mp_raise_ValueError(MP_ERROR_TEXT("flush_worker and async_refresh are exclusive"));
+	}
+	self->hold_display = 0;
+	amoled_damage_init(&self->damage);
+	self->shadow = NULL;
+	self->shadow_valid = false;
+	self->screen.scroll_top = 0;
+	self->screen.scroll_rows = 0;
+	self->screen.scroll_offset = 0;
+	self->scroll_pending = false;
+	self->screen.damage = screen_damage;
+	self->screen.ctx = self;
+	self->transpose = false;
+	for (int i = 0; i < AMOLED_LAYERS; i++) {
+		self->layers[i].buffer = MP_OBJ_NULL;
+		self->layers[i].visible = false;
+	}
+	self->layer_row = NULL;
+	self->sprites = mp_obj_new_list(0, NULL);
+	self->target = &self->screen;
+	self->target_obj = MP_OBJ_NULL;
+	amoled_dlist_init(&self->dlist);
+	self->dlist_objs = mp_obj_new_list(0, NULL);
+
+#if AMOLED_STATS
+    memset(&self->stats, 0, sizeof(amoled_stats_t));
+#endif
 
     // 2 bytes for each pixel. so maximum will be width * height * 2
-    frame_buffer_alloc(self, self->width * self->height * 2);
-    
-    self->reset       = args[ARG_reset].u_obj;
-    self->reset_level = args[ARG_reset_level].u_bool;
-    self->color_space = args[ARG_color_space].u_int;
-    self->bpp         = args[ARG_bpp].u_int;
-
-    // reset
-    if (self->reset != MP_OBJ_NULL) {
-        mp_hal_pin_obj_t reset_pin = mp_hal_get_pin_obj(self->reset);
-        mp_hal_pin_output(reset_pin);
-    }
-
-	// set RGB or BGR
-    switch (self->color_space) {
-        case COLOR_SPACE_RGB:
-            self->madctl_val = 0;
-        break;
-
-        case COLOR_SPACE_BGR:
-            self->madctl_val |= (1 << 3);
-        break;
-
-        default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported color space"));
-        break;
-    }
-
+    // bpp 8 and 4 keep palette indexes instead, expanded to RGB565 when refreshed
+    self->bpp = args[ARG_bpp].u_int;
 	// set BPP
     switch (self->bpp) {
         case 16:
+        case 8:
+        case 4:
             self->colmod_cal = 0x55;
             self->fb_bpp = 16;
         break;
@@ -270,6 +769,41 @@ mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t
         break;
     }
 
+    // 18 and 24 bpp keep RGB565 in the frame buffer, expanded to 3 bytes per pixel when refreshed
+    self->bus_pixel_bytes = (self->fb_bpp == 16) ? 2 : 3;
+    amoled_blit_expand_init(&self->expand, self->fb_bpp);
+    self->pixel_bits = ((self->bpp == 8) || (self->bpp == 4)) ? self->bpp : 16;
+    if ((self->pixel_bits == 4) && ((self->width & 1) || (self->height & 1))) {
+        mp_raise_ValueError(MP_ERROR_TEXT("4 bpp needs an EVEN width and height"));
+    }
+    // monochrome : 1 bit per pixel, expanded to the two palette colors
+    self->color_space = args[ARG_color_space].u_int;
+    if (self->color_space == COLOR_SPACE_MONOCHROME) {
+        if (self->bpp != 16) {
+            mp_raise_ValueError(MP_ERROR_TEXT("monochrome needs bpp 16"));
+        }
+        self->pixel_bits = 1;
+    }
+
+	// set RGB or BGR
+    switch (self->color_space) {
+        case COLOR_SPACE_RGB:
+            self->madctl_val = 0;
+        break;
+
+        case COLOR_SPACE_BGR:
+            self->madctl_val |= (1 << 3);
+        break;
+
+        case COLOR_SPACE_MONOCHROME:
+            self->madctl_val = 0;
+        break;
+
+        default:
+            mp_raise_ValueError(MP_ERROR_TEXT("unsupported color space"));
+        break;
+    }
+
     bzero(&self->rotations, sizeof(self->rotations));
 	switch (self->type) {
         case 0:
@@ -285,6 +819,62 @@ mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t
             mp_raise_ValueError(MP_ERROR_TEXT("Unsupported display type"));
         break;
 	}
+    // the frame buffer is sized from the bus while drawing uses the rotation table sizes : they must agree
+    if (!(((self->width == self->rotations[0].width) && (self->height == self->rotations[0].height)) ||
+          ((self->width == self->rotations[0].height) && (self->height == self->rotations[0].width)))) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bus width and height do not match the display type"));
+    }
+
+    // reset and tearing effect pins are looked up before anything is allocated
+    self->reset       = args[ARG_reset].u_obj;
+    self->reset_level = args[ARG_reset_level].u_bool;
+    if (self->reset != MP_OBJ_NULL) {
+        mp_hal_pin_obj_t reset_pin = mp_hal_get_pin_obj(self->reset);
+        mp_hal_pin_output(reset_pin);
+    }
+    if (args[ARG_te].u_obj != MP_OBJ_NULL) {
+        mp_hal_get_pin_obj(args[ARG_te].u_obj);
+    }
+
+    frame_buffer_alloc(self, (self->width * self->height * self->pixel_bits + 7) / 8);
+    // double_buffer : primitives draw in frame_buffer while the refresh sends front
+    self->front = self->frame_buffer;
+    self->double_buffer = args[ARG_double_buffer].u_bool;
+    if (self->double_buffer) {
+        self->front = m_malloc(self->frame_buffer_size);
+        if (self->front == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate Frame Buffer."));
+        }
+        memset(self->front, 0, self->frame_buffer_size);
+        AMOLED_STATS_ADD(&self->stats, allocations, 1);
+        self->fb_dma_capable &= esp_ptr_dma_capable(self->front);
+    }
+    palette_reset(self);
+
+    // staging buffers must hold at least one row whatever the rotation
+    size_t staging_size = args[ARG_staging_size].u_int;
+    size_t row_max = self->bus_pixel_bytes * ((self->width > self->height) ? self->width : self->height);
+    staging_alloc(self, (staging_size < row_max) ? row_max : staging_size);
+    memset(self->staging_fence, 0, sizeof(self->staging_fence));
+
+    // the flush worker sends the damaged areas from the other core
+    // Its state is outside the GC heap : the thread uses it until the finaliser has stopped it
+    if (args[ARG_flush_worker].u_bool) {
+        amoled_worker_t *worker = heap_caps_malloc(sizeof(amoled_worker_t), MALLOC_CAP_INTERNAL);
+        if (worker == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to start the flush worker."));
+        }
+        if (!amoled_worker_start(worker, flush_worker_job, self, FLUSH_WORKER_CORE)) {
+            heap_caps_free(worker);
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to start the flush worker."));
+        }
+        self->worker = worker;
+    }
+    
+    // tearing effect input
+    self->te = args[ARG_te].u_obj;
+    te_init(self);
+
     set_rotation(self, 0);
     return MP_OBJ_FROM_PTR(self);
 }
@@ -300,11 +890,30 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_0(amoled_AMOLED_version_obj, amoled_AMOLED_versio
 STATIC mp_obj_t amoled_AMOLED_deinit(mp_obj_t self_in) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
+    flush_sync(self);
+    if (self->worker) {
+        amoled_worker_stop(self->worker);
+        heap_caps_free(self->worker);
+        self->worker = NULL;
+    }
+    te_deinit(self);
     if (self->lcd_panel_p) {
         self->lcd_panel_p->deinit(self->bus_obj);
     }
 
     gc_free(self->frame_buffer);
+    if (self->double_buffer) {
+        gc_free(self->front);
+    }
+    staging_free(self, false);
+    if (self->shadow) {
+        m_free(self->shadow);
+        self->shadow = NULL;
+    }
+    if (self->layer_row) {
+        m_free(self->layer_row);
+        self->layer_row = NULL;
+    }
 
     //m_del_obj(amoled_AMOLED_obj_t, self); 
     return mp_const_none;
@@ -313,6 +922,24 @@ STATIC mp_obj_t amoled_AMOLED_deinit(mp_obj_t self_in) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_deinit_obj, amoled_AMOLED_deinit);
 
 
+// Finaliser : only releases what lives outside the Micropython heap (the GC frees the rest), the bus
+// and the buffers may already be collected. Runs after a failed construction, on collection and soft reset
+STATIC mp_obj_t amoled_AMOLED_del(mp_obj_t self_in) {
+    amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    te_deinit(self);
+    if (self->worker) {
+        amoled_worker_abort(self->worker);      // before the staging buffers it may be sending
+        heap_caps_free(self->worker);
+        self->worker = NULL;
+    }
+    staging_free(self, true);
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_del_obj, amoled_AMOLED_del);
+
+
 STATIC mp_obj_t amoled_AMOLED_reset(mp_obj_t self_in) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
@@ -417,155 +1044,960 @@ STATIC mp_obj_t amoled_AMOLED_send_cmd(size_t n_args, const mp_obj_t *args)
     return mp_const_none;
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_send_cmd_obj, 4, 4, amoled_AMOLED_send_cmd);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_send_cmd_obj, 4, 4, amoled_AMOLED_send_cmd);
+
+/*-----------------------------------------------------------------------------------------------------
+Below are buffers and screen buffers related function.
+------------------------------------------------------------------------------------------------------*/
+
+STATIC uint16_t colorRGB(uint8_t r, uint8_t g, uint8_t b) {
+    uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
+    return ((((c) >> 8) & 0x00FF) | (((c) << 8) & 0xFF00));
+}
+
+
+STATIC mp_obj_t amoled_AMOLED_colorRGB(size_t n_args, const mp_obj_t *args) {
+    return MP_OBJ_NEW_SMALL_INT(colorRGB(
+        (uint8_t)mp_obj_get_int(args[1]),
+        (uint8_t)mp_obj_get_int(args[2]),
+        (uint8_t)mp_obj_get_int(args[3])));
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_colorRGB_obj, 4, 4, amoled_AMOLED_colorRGB);
+
+
+// x0, y0, x1, y1 are panel memory columns and rows : frame buffer rows and columns when transposed
+STATIC void set_area(amoled_AMOLED_obj_t *self, amoled_stats_t *stats, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    uint16_t max_x = self->transpose ? self->max_height_value : self->max_width_value;
+    uint16_t max_y = self->transpose ? self->max_width_value : self->max_height_value;
+
+    if ((x0 <= x1) & (x1 <= max_x) & (y0 <= y1) & (y1 <= max_y)) {
+
+		/* As RM69090 driver need offset (see ORIENTATIONS_GENERAL) then the memory area needs to follow offsets*/
+		x0 += self->x_gap;
+		y0 += self->y_gap;
+		x1 += self->x_gap;
+		y1 += self->y_gap;
+
+		uint8_t bufx[4] = {
+			((x0 >> 8) & 0xFF),	// SC9 and SC8 are > 8 bits 
+			(x0 & 0xFF),		// SC7 to SC0 are < 8 bits
+			((x1 >> 8) & 0xFF),	// EC9 and EC8
+			(x1 & 0xFF)};		// and so
+		uint8_t bufy[4] = {
+			((y0 >> 8) & 0xFF),	// SP9 and SP8...
+			(y0 & 0xFF),
+			((y1 >> 8) & 0xFF),
+			(y1 & 0xFF)};
+		uint8_t bufz[1] = { 0x00 };
+	
+		tx_param(self, stats, LCD_CMD_CASET, bufx, 4);
+		tx_param(self, stats, LCD_CMD_RASET, bufy, 4);
+		tx_param(self, stats, LCD_CMD_RAMWR, bufz, 0);  /* strict copy of Lilygo AMOLED */
+	}
+}
+
+// True when a visible layer covers part of the frame buffer area x, y, w, h
+STATIC bool layers_cross(amoled_AMOLED_obj_t *self, int x, int y, int w, int h) {
+	for (int i = 0; i < AMOLED_LAYERS; i++) {
+		amoled_layer_t *l = &self->layers[i];
+		if (l->visible && (l->x < x + w) && (l->x + l->w > x) && (l->y < y + h) && (l->y + l->h > y)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Composite the visible layers, lowest first, over row : the RGB565 frame buffer pixels x..x+w-1 of row y
+STATIC void layers_compose(amoled_AMOLED_obj_t *self, uint16_t *row, int x, int y, uint16_t w) {
+	for (int i = 0; i < AMOLED_LAYERS; i++) {
+		amoled_layer_t *l = &self->layers[i];
+		if (!l->visible || (y < l->y) || (y >= l->y + l->h)) {
+			continue;
+		}
+		int x0 = (l->x > x) ? l->x : x;
+		int x1 = ((l->x + l->w) < (x + w)) ? (l->x + l->w) : (x + w);
+		if (x0 < x1) {
+			amoled_blit_compose(&row[x0 - x], &l->pixels[((y - l->y) * l->w) + (x0 - l->x)], x1 - x0,
+				l->key, l->alpha);
+		}
+	}
+}
+
+// RGB565 values of w pixels of the front frame from pixel idx (palette indexes expanded)
+STATIC void front_rgb565(amoled_AMOLED_obj_t *self, uint16_t *dst, size_t idx, uint16_t w) {
+	if (self->pixel_bits == 16) {
+		memcpy(dst, &self->front[idx], 2 * w);
+	} else if (self->pixel_bits == 8) {
+		amoled_blit_lut8(dst, front_addr(self, idx), self->lut, w);
+	} else if (self->pixel_bits == 4) {
+		amoled_blit_lut4(dst, front_addr(self, idx), self->lut, w);
+	} else {
+		amoled_blit_lut1(dst, (uint8_t *)self->front, idx, self->lut, w);
+	}
+}
+
+// Copy rows of w pixels from the frame buffer pixel x, y to a staging buffer in the panel pixel format
+// (palette indexes expanded to RGB565, layers composited, RGB565 expanded to RGB666 / RGB888)
+STATIC void stage_rows(amoled_AMOLED_obj_t *self, uint16_t *staging, uint16_t x, uint16_t y, uint16_t w, uint16_t rows) {
+	uint8_t *dst = (uint8_t *)staging;
+	size_t idx = (y * self->width) + x;
+
+	for (uint16_t row = 0; row < rows; row++) {
+		bool layered = layers_cross(self, x, y + row, w, 1);
+		if ((self->bus_pixel_bytes == 3) && !layered) {
+			amoled_blit_expand24(dst, &self->front[idx], &self->expand, w);
+		} else {
+			// deep color rows are composited aside, then expanded
+			uint16_t *rgb = (self->bus_pixel_bytes == 3) ? self->layer_row : (uint16_t *)dst;
+			front_rgb565(self, rgb, idx, w);
+			if (layered) {
+				layers_compose(self, rgb, x, y + row, w);
+			}
+			if (self->bus_pixel_bytes == 3) {
+				amoled_blit_expand24(dst, rgb, &self->expand, w);
+			}
+		}
+		dst += self->bus_pixel_bytes * w;
+		idx += self->width;
+	}
+}
+
+// Send one aligned area of a transposed frame_buffer : the area columns are the panel window rows
+// Bands of columns are transposed into the staging pool, the panel flips finish the rotation
+STATIC void flush_area_transposed(amoled_AMOLED_obj_t *self, const amoled_area_t *area, amoled_worker_counters_t *counters) {
+	uint16_t w1 = area->x1 - area->x0 + 1;
+	uint16_t h1 = area->y1 - area->y0 + 1;
+	size_t row_size = self->bus_pixel_bytes * h1;		// a panel row is a frame buffer column
+	uint16_t band = self->staging_size / row_size;
+	bool layered = layers_cross(self, area->x0, area->y0, w1, h1);
+
+	set_area(self, COUNTERS_STATS(counters), area->y0, area->x0, area->y1, area->x1);
+
+	for (uint16_t col = 0; col < w1; col += band) {
+		uint16_t cols = (w1 - col < band) ? (w1 - col) : band;
+		uint8_t idx = self->staging_idx;
+		uint16_t *staging = self->staging[idx];
+		self->staging_idx = (idx + 1) % AMOLED_STAGING_BUFFERS;
+
+		if (self->staging_fence[idx]) {
+			wait_panel(self, COUNTERS_STATS(counters), self->staging_fence[idx]);
+			self->staging_fence[idx] = 0;
+		}
+		AMOLED_STATS_START(start);
+		size_t buf_idx = (area->y0 * self->width) + area->x0 + col;
+		if (layered) {
+			// composite each frame buffer row of the band, it becomes a column of the staging buffer
+			for (uint16_t r = 0; r < h1; r++) {
+				front_rgb565(self, self->layer_row, buf_idx + (r * self->width), cols);
+				layers_compose(self, self->layer_row, area->x0 + col, area->y0 + r, cols);
+				if (self->bus_pixel_bytes == 3) {
+					amoled_blit_transpose_expand24((uint8_t *)staging + (3 * r), h1, self->layer_row, cols,
+						&self->expand, cols, 1);
+				} else {
+					amoled_blit_transpose16(staging + r, h1, self->layer_row, cols, cols, 1);
+				}
+			}
+		} else if (self->bus_pixel_bytes == 3) {
+			amoled_blit_transpose_expand24((uint8_t *)staging, h1, &self->front[buf_idx], self->width,
+				&self->expand, cols, h1);
+		} else if (self->pixel_bits == 16) {
+			amoled_blit_transpose16(staging, h1, &self->front[buf_idx], self->width, cols, h1);
+		} else if (self->pixel_bits == 8) {
+			amoled_blit_transpose_lut8(staging, h1, front_addr(self, buf_idx), self->width, self->lut, cols, h1);
+		} else if (self->pixel_bits == 4) {
+			amoled_blit_transpose_lut4(staging, h1, front_addr(self, buf_idx & ~1), self->width / 2, buf_idx & 1,
+				self->lut, cols, h1);
+		} else {
+			amoled_blit_transpose_lut1(staging, h1, (uint8_t *)self->front, self->width, buf_idx,
+				self->lut, cols, h1);
+		}
+		AMOLED_STATS_ADD(COUNTERS_STATS(counters), staging_bytes, cols * row_size);
+		AMOLED_STATS_STOP(COUNTERS_STATS(counters), copy_us, start);
+		self->staging_fence[idx] = send_color(self, COUNTERS_STATS(counters), (col == 0) ? LCD_CMD_RAMWR : LCD_CMD_RAMWRC, staging, cols * row_size);
+	}
+
+	counters->windows++;
+	counters->bytes_sent += row_size * w1;
+}
+
+// Send one aligned area of the frame_buffer to the display memory
+STATIC void flush_area(amoled_AMOLED_obj_t *self, const amoled_area_t *area, amoled_worker_counters_t *counters) {
+	
+	size_t buf_idx;
+
+	if (self->transpose) {
+		flush_area_transposed(self, area, counters);
+		return;
+	}
+	
+	uint16_t w1 = area->x1 - area->x0 + 1;
+	uint16_t h1 = area->y1 - area->y0 + 1;
+	size_t row_size = self->bus_pixel_bytes * w1;
+	size_t size = row_size * h1;
+
+	set_area(self, COUNTERS_STATS(counters), area->x0, area->y0, area->x1, area->y1);
+
+	// Indexed and deep color frame buffers are always expanded through the staging pool, and so are layers
+	bool direct = self->fb_dma_capable && (self->pixel_bits == 16) && (self->bus_pixel_bytes == 2) &&
+		!layers_cross(self, area->x0, area->y0, w1, h1);
+
+	if (direct && (w1 == self->width)) {
+		// Full width rows follow each other in frame_buffer, send them without any copy
+		send_color(self, COUNTERS_STATS(counters), LCD_CMD_RAMWR, &self->front[area->y0 * self->width], size);
+	} else if (direct && (row_size > ROW_TX_OVERHEAD_BYTES)) {
+		// Long rows : one memory write per row straight from frame_buffer is cheaper than a copy
+		buf_idx = (area->y0 * self->width) + area->x0;
+		send_color(self, COUNTERS_STATS(counters), LCD_CMD_RAMWR, &self->front[buf_idx], row_size);
+		for (uint16_t line = 1; line < h1; line++) {
+			buf_idx += self->width;
+			send_color(self, COUNTERS_STATS(counters), LCD_CMD_RAMWRC, &self->front[buf_idx], row_size);
+		}
+	} else {
+		// Gather the window in bands of rows through the staging pool
+		// In async mode a band is copied while the previous one is still on the bus
+		uint16_t band = self->staging_size / row_size;
+		
+		for (uint16_t line = 0; line < h1; line += band) {
+			uint16_t rows = (h1 - line < band) ? (h1 - line) : band;
+			uint8_t idx = self->staging_idx;
+			uint16_t *staging = self->staging[idx];
+			self->staging_idx = (idx + 1) % AMOLED_STAGING_BUFFERS;
+
+			if (self->staging_fence[idx]) {
+				wait_panel(self, COUNTERS_STATS(counters), self->staging_fence[idx]);
+				self->staging_fence[idx] = 0;
+			}
+			AMOLED_STATS_START(start);
+			stage_rows(self, staging, area->x0, area->y0 + line, w1, rows);
+			AMOLED_STATS_ADD(COUNTERS_STATS(counters), staging_bytes, rows * row_size);
+			AMOLED_STATS_STOP(COUNTERS_STATS(counters), copy_us, start);
+			self->staging_fence[idx] = send_color(self, COUNTERS_STATS(counters), (line == 0) ? LCD_CMD_RAMWR : LCD_CMD_RAMWRC, staging, rows * row_size);
+		}
+	}
+
+	counters->windows++;
+	counters->bytes_sent += size;
+}
+
+STATIC void flush_worker_job(void *ctx, const amoled_area_t *area, amoled_worker_counters_t *counters) {
+	flush_area((amoled_AMOLED_obj_t *)ctx, area, counters);
+}
+
+// Send an area now, or hand it to the flush worker
+STATIC void submit_area(amoled_AMOLED_obj_t *self, const amoled_area_t *area) {
+	if (self->worker) {
+		amoled_worker_push(self->worker, area);
+	} else {
+		amoled_worker_counters_t counters;
+		memset(&counters, 0, sizeof(counters));
+		flush_area(self, area, &counters);
+		counters_merge(self, &counters);
+	}
+}
+
+// Copy a sent area of the frame_buffer to the shadow frame
+STATIC void shadow_update(amoled_AMOLED_obj_t *self, const amoled_area_t *area) {
+	size_t row_size = fb_bytes(self, area->x1 - area->x0 + 1);
+	size_t offset = fb_bytes(self, (area->y0 * self->width) + area->x0);
+	size_t stride = fb_bytes(self, self->width);
+
+	for (uint16_t line = area->y0; line <= area->y1; line++) {
+		memcpy((uint8_t *)self->shadow + offset, (uint8_t *)self->front + offset, row_size);
+		offset += stride;
+	}
+}
+
+// Pixels in a 32 bits word of the frame buffer
+#define FB_WORD_PIXELS(self) (32 / (self)->pixel_bits)
+
+// Send a shadow run of rows y0 to y1, words lo to hi of the area
+STATIC void shadow_flush_run(amoled_AMOLED_obj_t *self, const amoled_area_t *area, uint16_t y0, uint16_t y1, uint16_t lo, uint16_t hi) {
+	uint16_t ppw = FB_WORD_PIXELS(self);
+	amoled_area_t run = {
+		.x0 = area->x0 + ppw * lo,
+		.y0 = y0,
+		.x1 = area->x0 + ppw * (hi + 1) - 1,
+		.y1 = y1
+	};
+	submit_area(self, &run);
+	shadow_update(self, &run);
+}
+
+// Compare an area with the shadow frame in 32 bits words (2 pixels, 4 or 8 indexes) and only send the changed spans
+// Rows are compared by pairs to keep the panel rule, consecutive changed pairs share one window
+// (the staging path continues it with RAMWRC) while widening it costs less than a new window
+STATIC void flush_area_diff(amoled_AMOLED_obj_t *self, const amoled_area_t *area) {
+	amoled_damage_t *damage = &self->damage;
+	uint32_t start = mp_hal_ticks_us();
+	uint16_t ppw = FB_WORD_PIXELS(self);
+	uint16_t words = (area->x1 - area->x0 + 1) / ppw;
+	bool active = false;
+	uint16_t run_y0 = 0, run_y1 = 0, run_lo = 0, run_hi = 0;
+
+	for (uint16_t y = area->y0; y <= area->y1; y += 2) {
+		uint16_t rows = (y < area->y1) ? 2 : 1;
+		uint16_t lo = words, hi = 0;
+
+		for (uint16_t r = 0; r < rows; r++) {
+			size_t idx = (((y + r) * self->width) + area->x0) / ppw;
+			const uint32_t *fb = &((const uint32_t *)self->front)[idx];
+			const uint32_t *sh = &((const uint32_t *)self->shadow)[idx];
+			uint16_t first = 0;
+			while ((first < words) && (fb[first] == sh[first])) {
+				first++;
+			}
+			if (first == words) {
+				continue;
+			}
+			uint16_t last = words - 1;
+			while (fb[last] == sh[last]) {
+				last--;
+			}
+			lo = (first < lo) ? first : lo;
+			hi = (last > hi) ? last : hi;
+		}
+		damage->bytes_compared += (size_t)words * 4 * rows;
+
+		if (lo > hi) {
+			// Unchanged pair ends the run
+			if (active) {
+				shadow_flush_run(self, area, run_y0, run_y1, run_lo, run_hi);
+				active = false;
+			}
+			continue;
+		}
+		if (active) {
+			uint16_t u_lo = (lo < run_lo) ? lo : run_lo;
+			uint16_t u_hi = (hi > run_hi) ? hi : run_hi;
+			uint32_t run_px = ppw * (run_hi - run_lo + 1) * (run_y1 - run_y0 + 1);
+			uint32_t pair_px = ppw * (hi - lo + 1) * rows;
+			uint32_t union_px = ppw * (u_hi - u_lo + 1) * (y + rows - run_y0);
+			if (union_px <= run_px + pair_px + damage->overhead) {
+				run_lo = u_lo;
+				run_hi = u_hi;
+				run_y1 = y + rows - 1;
+				continue;
+			}
+			shadow_flush_run(self, area, run_y0, run_y1, run_lo, run_hi);
+		}
+		active = true;
+		run_y0 = y;
+		run_y1 = y + rows - 1;
+		run_lo = lo;
+		run_hi = hi;
+	}
+	if (active) {
+		shadow_flush_run(self, area, run_y0, run_y1, run_lo, run_hi);
+	}
+	damage->diff_us += mp_hal_ticks_us() - start;
+}
+
+// Copy an area of the front frame to the frame drawn next : both frames then only differ by what is drawn
+// after the swap. 4 and 1 bit pixels are copied in whole bytes, the pixels around the area are equal anyway
+STATIC void copy_forward(amoled_AMOLED_obj_t *self, const amoled_area_t *area) {
+	AMOLED_STATS_START(start);
+	for (uint16_t y = area->y0; y <= area->y1; y++) {
+		size_t first = (y * self->width) + area->x0;
+		size_t lo = fb_bytes(self, first);
+		size_t hi = ((first + area->x1 - area->x0 + 1) * self->pixel_bits + 7) / 8;
+		memcpy((uint8_t *)self->frame_buffer + lo, (uint8_t *)self->front + lo, hi - lo);
+	}
+	AMOLED_STATS_STOP(&self->stats, copy_us, start);
+}
+
+// Send every damaged area to the display and forget them
+// Double buffered, the drawn frame is swapped with the front one first and the areas copied forward
+STATIC void flush_damage(amoled_AMOLED_obj_t *self) {
+	amoled_damage_t *damage = &self->damage;
+	amoled_area_t area;
+	bool first = true;
+	bool whole = false;
+	// Shadow diffing compares 32 bits words : every row must start word aligned
+	// It can not see a layer change, the frame buffer under it did not change
+	uint16_t ppw = FB_WORD_PIXELS(self);
+	bool diff = self->shadow && self->shadow_valid && !(self->width % ppw) &&
+		!layers_cross(self, 0, 0, self->width, self->height);
+
+	// Page flipping : the frame drawn so far becomes the front one, sent while the next one is drawn
+	if (self->double_buffer) {
+		if (!amoled_damage_pending(damage)) {
+			return;
+		}
+		flush_sync(self);			// the previous front frame may still be on its way
+		uint16_t *drawn = self->frame_buffer;
+		self->frame_buffer = self->front;
+		self->front = drawn;
+		screen_sync(self);
+	}
+
+	// Areas are removed before being sent so an exception does not leave them pending forever
+	while (amoled_damage_next(damage, &area, self->width, self->height)) {
+		if (first) {
+			damage->flushes++;
+			first = false;
+		}
+		if (diff && !(area.x0 % ppw) && !((area.x1 - area.x0 + 1) % ppw)) {
+			flush_area_diff(self, &area);
+		} else {
+			submit_area(self, &area);
+			if (self->shadow && self->shadow_valid) {
+				shadow_update(self, &area);
+			}
+		}
+		if (self->double_buffer) {
+			copy_forward(self, &area);
+		}
+		whole |= (amoled_area_pixels(&area) == (uint32_t)self->width * self->height);
+	}
+	// The shadow frame is only trusted again once the whole display was resent (after a rotation or a
+	// palette change) : a direct write like bitmap() leaves pixels a partial refresh does not cover
+	if (self->shadow && !self->shadow_valid && whole) {
+		memcpy(self->shadow, self->front, self->frame_buffer_size);
+		self->shadow_valid = true;
+	}
+	// After scroll() : the uncovered rows are on their way, move the displayed rows (write_spi waits for the worker)
+	if (self->scroll_pending) {
+		scroll_write_start(self);
+	}
+}
+
+// Bytes a window refresh of x, y, w, h would send (kept to measure what damage merging saves)
+STATIC size_t window_bytes(amoled_AMOLED_obj_t *self, int x, int y, int w, int h) {
+	amoled_area_t area;
+	
+	if (!amoled_damage_align(&area, x, y, w, h, self->width, self->height)) {
+		return 0;
+	}
+	return amoled_area_pixels(&area) * self->bus_pixel_bytes;
+}
+
+//This function is called by every primitive once drawn : x, y, w, h is the area the primitive used to refresh
+//Damaged areas recorded by the frame buffer writes are sent if auto_refresh is set and display is not hold
+//Nothing is sent while the primitives draw into a Surface
+STATIC void refresh_display(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+	
+	if (self->auto_refresh & !self->hold_display & (self->target == &self->screen)) {
+		self->damage.bytes_naive += window_bytes(self, x, y, w, h);
+		flush_damage(self);
+	}
+}
+
+//	refresh([x, y, w, h])
+STATIC mp_obj_t amoled_AMOLED_refresh(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	
+	if (n_args == 5) {	//if x, y, w, h exist, add this area to the damaged ones
+		mp_int_t x = mp_obj_get_int(args[1]);
+		mp_int_t y = mp_obj_get_int(args[2]);
+		mp_int_t w = mp_obj_get_int(args[3]);
+		mp_int_t h = mp_obj_get_int(args[4]);
+		invalidate(self, x, y, w, h);
+		self->damage.bytes_naive += window_bytes(self, x, y, w, h);
+	} else if (n_args == 1) {	//otherwise the whole screen is resent : restores the panel after bitmap() or a reset
+		invalidate(self, 0, 0, self->width, self->height);
+		self->damage.bytes_naive += window_bytes(self, 0, 0, self->width, self->height);
+	} else {
+		mp_raise_TypeError(MP_ERROR_TEXT("refresh takes 0 or 4 coordinates"));
+	}
+	flush_damage(self);
+	
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_refresh_obj, 1, 5, amoled_AMOLED_refresh);
+
+
+//	swap() presents the frame drawn so far : double buffered, it becomes the front frame and drawing
+//	goes on in the other one while it is sent. Only sends the damaged areas otherwise
+STATIC mp_obj_t amoled_AMOLED_swap(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	flush_damage(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_swap_obj, amoled_AMOLED_swap);
+
+
+//	begin() starts a batch : primitives only record their damage until the matching end()
+//	Batches nest, also __enter__ : "with tft:" is a batch
+STATIC mp_obj_t amoled_AMOLED_begin(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+	if (self->hold_display == UINT16_MAX) {
+		mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("batch nested too deep"));
+	}
+	self->hold_display++;
+	return self_in;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_begin_obj, amoled_AMOLED_begin);
+
+
+//	end() ends a batch, the outermost one sends the damage of the whole batch at once (if auto_refresh)
+STATIC mp_obj_t amoled_AMOLED_end(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+	if (self->hold_display == 0) {
+		mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("end() without begin()"));
+	}
+	self->hold_display--;
+	refresh_display(self, 0, 0, 0, 0);
+	return mp_const_none;
+}
+
+// Also __exit__(exc_type, exc_value, traceback) : the damage is sent even if the block raised
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_end_obj, 1, 4, amoled_AMOLED_end);
+
+
+//	batch() returns self for "with tft.batch():", the batch starts in __enter__
+STATIC mp_obj_t amoled_AMOLED_batch(mp_obj_t self_in) {
+	return self_in;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_batch_obj, amoled_AMOLED_batch);
+
+
+//	stats() returns the transfer statistics as a dict (empty when built with AMOLED_STATS=0)
+STATIC mp_obj_t amoled_AMOLED_stats(mp_obj_t self_in) {
+#if AMOLED_STATS
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	counters_collect(self);
+	return amoled_stats_dict(&self->stats);
+#else
+	return amoled_stats_dict(NULL);
+#endif
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_stats_obj, amoled_AMOLED_stats);
+
+
+STATIC mp_obj_t amoled_AMOLED_reset_stats(mp_obj_t self_in) {
+#if AMOLED_STATS
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	counters_collect(self);
+	memset(&self->stats, 0, sizeof(amoled_stats_t));
+#endif
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_reset_stats_obj, amoled_AMOLED_reset_stats);
+
+
+//	damage_stats([reset]) returns the damage tracker counters as a dict
+STATIC mp_obj_t amoled_AMOLED_damage_stats(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_damage_t *damage = &self->damage;
+	mp_obj_t dict = mp_obj_new_dict(8);
+
+	counters_collect(self);
+
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_pending), mp_obj_new_int_from_uint(amoled_damage_pending(damage)));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_invalidations), mp_obj_new_int_from_uint(damage->invalidations));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_merges), mp_obj_new_int_from_uint(damage->merges));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_flushes), mp_obj_new_int_from_uint(damage->flushes));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_windows), mp_obj_new_int_from_uint(damage->windows));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes_naive), mp_obj_new_int_from_ull(damage->bytes_naive));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes_sent), mp_obj_new_int_from_ull(damage->bytes_sent));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes_saved), mp_obj_new_int((mp_int_t)(damage->bytes_naive - damage->bytes_sent)));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes_compared), mp_obj_new_int_from_ull(damage->bytes_compared));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_diff_us), mp_obj_new_int_from_uint(damage->diff_us));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_shadow_valid), mp_obj_new_bool(self->shadow && self->shadow_valid));
+
+	if ((n_args > 1) && mp_obj_is_true(args[1])) {
+		amoled_damage_reset_stats(damage);
+	}
+	return dict;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_damage_stats_obj, 1, 2, amoled_AMOLED_damage_stats);
+
+
+//	damage_mode([mode[, overhead]]) selects the damage tracker, returns the current mode
+//	mode is DAMAGE_RECTS or DAMAGE_TILES, overhead is the cost of a new window in pixels used by both
+STATIC mp_obj_t amoled_AMOLED_damage_mode(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+	if (n_args > 1) {
+		flush_damage(self);		// damage recorded by the previous mode is not lost
+		if (!amoled_damage_set_mode(&self->damage, mp_obj_get_int(args[1]), self->width, self->height)) {
+			mp_raise_ValueError(MP_ERROR_TEXT("unsupported damage mode"));
+		}
+	}
+	if (n_args > 2) {
+		mp_int_t overhead = mp_obj_get_int(args[2]);
+		if (overhead < 0) {
+			mp_raise_ValueError(MP_ERROR_TEXT("overhead must be positive"));
+		}
+		self->damage.overhead = overhead;
+	}
+	return mp_obj_new_int(self->damage.mode);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_damage_mode_obj, 1, 3, amoled_AMOLED_damage_mode);
+
+
+//	shadow_diff([enable]) keeps a copy of the last sent frame and only sends what changed, returns the state
+STATIC mp_obj_t amoled_AMOLED_shadow_diff(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+	if (n_args > 1) {
+		bool enable = mp_obj_is_true(args[1]);
+		if (enable && (self->pixel_bits == 1)) {
+			mp_raise_ValueError(MP_ERROR_TEXT("no shadow frame in monochrome"));
+		}
+		if (enable && (self->shadow == NULL)) {
+			self->shadow = m_malloc(self->frame_buffer_size);
+			if (self->shadow == NULL) {
+				mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate shadow frame."));
+			}
+			AMOLED_STATS_ADD(&self->stats, allocations, 1);
+			// The display is up to date once the pending areas are sent
+			flush_damage(self);
+			flush_sync(self);
+			memcpy(self->shadow, self->front, self->frame_buffer_size);
+			self->shadow_valid = true;
+		} else if (!enable && self->shadow) {
+			m_free(self->shadow);
+			self->shadow = NULL;
+			self->shadow_valid = false;
+		}
+	}
+	return mp_obj_new_bool(self->shadow != NULL);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_shadow_diff_obj, 1, 2, amoled_AMOLED_shadow_diff);
+
+
+//	palette(index[, colors]) gets the RGB565 color of a palette index, or sets it
+//	colors may be a sequence : consecutive indexes from index are set
+//	Setting the palette resends the whole frame buffer (at once if auto_refresh is set) : a palette
+//	animation only costs the refresh, nothing is redrawn
+STATIC mp_obj_t amoled_AMOLED_palette(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_int_t index = mp_obj_get_int(args[1]);
+	mp_int_t entries = 1 << self->pixel_bits;
+
+	if (self->pixel_bits == 16) {
+		mp_raise_ValueError(MP_ERROR_TEXT("no palette with a RGB565 frame buffer"));
+	}
+	if ((index < 0) || (index >= entries)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("palette index out of range"));
+	}
+	if (n_args < 3) {
+		return mp_obj_new_int(self->lut[index]);
+	}
+
+	size_t len = 1;
+	mp_obj_t *items = (mp_obj_t *)&args[2];
+	if (!mp_obj_is_int(args[2])) {
+		mp_obj_get_array(args[2], &len, &items);
+	}
+	if (index + len > (size_t)entries) {
+		mp_raise_ValueError(MP_ERROR_TEXT("palette index out of range"));
+	}
+	flush_sync(self);			// areas being sent still use the previous colors
+	for (size_t i = 0; i < len; i++) {
+		self->lut[index + i] = mp_obj_get_int(items[i]);
+	}
+	// the indexes did not change : the shadow frame can not tell what to resend
+	self->shadow_valid = false;
+	damage_rows(self, 0, 0, self->width, self->height);
+	if (self->auto_refresh && !self->hold_display) {
+		flush_damage(self);
+	}
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_palette_obj, 2, 3, amoled_AMOLED_palette);
+
+
+// Layer n of the arguments, it must have pixels unless attached is false
+STATIC amoled_layer_t *layer_arg(amoled_AMOLED_obj_t *self, mp_obj_t n_in, bool attached) {
+	mp_int_t n = mp_obj_get_int(n_in);
+	if ((n < 0) || (n >= AMOLED_LAYERS)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("layer index out of range"));
+	}
+	if (attached && (self->layers[n].buffer == MP_OBJ_NULL)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("layer has no buffer"));
+	}
+	return &self->layers[n];
+}
+
+// Damage the frame buffer area a layer covers : it is composited again on the next flush
+STATIC void layer_damage(amoled_AMOLED_obj_t *self, amoled_layer_t *l) {
+	if (l->visible) {
+		damage_rows(self, l->x, l->y, l->w, l->h);
+	}
+}
+
+// The display memory under a layer no longer matches the frame buffer nor the shadow frame
+// Areas under a visible layer are not diffed anyway : once none is left the whole screen is resent to rebuild it
+STATIC void layer_changed(amoled_AMOLED_obj_t *self) {
+	self->shadow_valid = false;
+	if (self->shadow && !layers_cross(self, 0, 0, self->width, self->height)) {
+		invalidate(self, 0, 0, self->width, self->height);
+	}
+	if (self->auto_refresh && !self->hold_display) {
+		flush_damage(self);
+	}
+}
+
+//	layer(n, buffer, w, h[, x, y]) attaches a w x h RGB565 pixel buffer (same format as bitmap()) as layer n
+//	at the frame buffer position x, y (0, 0 by default), visible, opaque and without color key
+//	layer(n, None) detaches it. Layers are composited over the frame buffer when the damaged areas are sent,
+//	layer n over layer n - 1 : moving or changing one never redraws the frame buffer under it
+STATIC mp_obj_t amoled_AMOLED_layer(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], false);
+	mp_buffer_info_t bufinfo = { 0 };
+	mp_int_t w = 0;
+	mp_int_t h = 0;
+
+	if (args[2] != mp_const_none) {
+		if (n_args < 5) {
+			mp_raise_TypeError(MP_ERROR_TEXT("layer needs buffer, w and h"));
+		}
+		w = mp_obj_get_int(args[3]);
+		h = mp_obj_get_int(args[4]);
+		mp_get_buffer_raise(args[2], &bufinfo, MP_BUFFER_READ);
+		if ((w <= 0) || (h <= 0) || (w > INT16_MAX) || (h > INT16_MAX) || (bufinfo.len < (size_t)(2 * w * h))) {
+			mp_raise_ValueError(MP_ERROR_TEXT("layer buffer too small"));
+		}
+		if ((uintptr_t)bufinfo.buf & 1) {
+			mp_raise_ValueError(MP_ERROR_TEXT("layer buffer must be 16 bits aligned"));
+		}
+		if (self->layer_row == NULL) {
+			uint16_t side = (self->width > self->height) ? self->width : self->height;
+			self->layer_row = m_malloc(2 * side);
+			AMOLED_STATS_ADD(&self->stats, allocations, 1);
+		}
+	}
+
+	flush_sync(self);			// areas being sent still read the layer
+	layer_damage(self, l);
+	if (args[2] == mp_const_none) {
+		l->buffer = MP_OBJ_NULL;
+		l->pixels = NULL;
+		l->visible = false;
+	} else {
+		l->buffer = args[2];
+		l->pixels = bufinfo.buf;
+		l->w = w;
+		l->h = h;
+		l->x = (n_args > 5) ? mp_obj_get_int(args[5]) : 0;
+		l->y = (n_args > 6) ? mp_obj_get_int(args[6]) : 0;
+		l->key = -1;
+		l->alpha = 255;
+		l->visible = true;
+		layer_damage(self, l);
+	}
+	layer_changed(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_obj, 3, 7, amoled_AMOLED_layer);
+
+
+//	layer_move(n, x, y) moves layer n : only the old and new areas are sent
+STATIC mp_obj_t amoled_AMOLED_layer_move(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], true);
+
+	flush_sync(self);
+	layer_damage(self, l);
+	l->x = mp_obj_get_int(args[2]);
+	l->y = mp_obj_get_int(args[3]);
+	layer_damage(self, l);
+	layer_changed(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_move_obj, 4, 4, amoled_AMOLED_layer_move);
+
+
+//	layer_show(n, visible) shows or hides layer n
+STATIC mp_obj_t amoled_AMOLED_layer_show(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], true);
+	bool visible = mp_obj_is_true(args[2]);
+
+	if (visible != l->visible) {
+		flush_sync(self);
+		layer_damage(self, l);
+		l->visible = visible;
+		layer_damage(self, l);
+		layer_changed(self);
+	}
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_show_obj, 3, 3, amoled_AMOLED_layer_show);
+
+
+//	layer_key(n[, color]) makes the pixels of layer n equal to color transparent, no color key without color
+STATIC mp_obj_t amoled_AMOLED_layer_key(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], true);
+
+	flush_sync(self);
+	l->key = (n_args > 2) ? (mp_obj_get_int(args[2]) & 0xFFFF) : -1;
+	layer_damage(self, l);
+	layer_changed(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_key_obj, 2, 3, amoled_AMOLED_layer_key);
+
+
+//	layer_alpha(n, alpha) sets the opacity of layer n, 0 (transparent) to 255 (opaque)
+STATIC mp_obj_t amoled_AMOLED_layer_alpha(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], true);
+	mp_int_t alpha = mp_obj_get_int(args[2]);
+
+	if ((alpha < 0) || (alpha > 255)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("alpha must be 0 to 255"));
+	}
+	flush_sync(self);
+	l->alpha = alpha;
+	layer_damage(self, l);
+	layer_changed(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_alpha_obj, 3, 3, amoled_AMOLED_layer_alpha);
+
+
+//	layer_update(n[, x, y, w, h]) sends again the layer n pixels modified in its buffer, the whole layer
+//	or its area x, y, w, h (layer coordinates)
+STATIC mp_obj_t amoled_AMOLED_layer_update(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_layer_t *l = layer_arg(self, args[1], true);
+
+	if (!l->visible) {
+		return mp_const_none;
+	}
+	if (n_args > 5) {
+		mp_int_t x = mp_obj_get_int(args[2]);
+		mp_int_t y = mp_obj_get_int(args[3]);
+		mp_int_t w = mp_obj_get_int(args[4]);
+		mp_int_t h = mp_obj_get_int(args[5]);
+		// clipped to the layer, the frame buffer around it is not affected
+		if (x < 0) {
+			w += x;
+			x = 0;
+		}
+		if (y < 0) {
+			h += y;
+			y = 0;
+		}
+		if (x + w > l->w) {
+			w = l->w - x;
+		}
+		if (y + h > l->h) {
+			h = l->h - y;
+		}
+		damage_rows(self, l->x + x, l->y + y, w, h);
+	} else {
+		layer_damage(self, l);
+	}
+	if (self->auto_refresh && !self->hold_display) {
+		flush_damage(self);
+	}
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_layer_update_obj, 2, 6, amoled_AMOLED_layer_update);
 
-/*-----------------------------------------------------------------------------------------------------
-Below are buffers and screen buffers related function.
-------------------------------------------------------------------------------------------------------*/
 
-STATIC uint16_t colorRGB(uint8_t r, uint8_t g, uint8_t b) {
-    uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
-    return ((((c) >> 8) & 0x00FF) | (((c) << 8) & 0xFF00));
+// Wait for the end of the queued transfers (async_refresh), frame_buffer can then be modified safely
+STATIC mp_obj_t amoled_AMOLED_wait(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	flush_sync(self);
+	return mp_const_none;
 }
 
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_wait_obj, amoled_AMOLED_wait);
 
-STATIC mp_obj_t amoled_AMOLED_colorRGB(size_t n_args, const mp_obj_t *args) {
-    return MP_OBJ_NEW_SMALL_INT(colorRGB(
-        (uint8_t)mp_obj_get_int(args[1]),
-        (uint8_t)mp_obj_get_int(args[2]),
-        (uint8_t)mp_obj_get_int(args[3])));
-}
-
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_colorRGB_obj, 4, 4, amoled_AMOLED_colorRGB);
 
+// True while queued transfers (async_refresh or flush_worker) are still on the bus
+STATIC mp_obj_t amoled_AMOLED_busy(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	if (self->worker) {
+		return mp_obj_new_bool(amoled_worker_busy(self->worker));
+	}
+	if (self->async_refresh && self->lcd_panel_p) {
+		return mp_obj_new_bool(self->lcd_panel_p->busy(self->bus_obj));
+	}
+	return mp_const_false;
+}
 
-STATIC void set_area(amoled_AMOLED_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-    if ((x0 <= x1) & (x1 <= self->max_width_value) & (y0 <= y1) & (y1 <= self->max_height_value)) {
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_busy_obj, amoled_AMOLED_busy);
 
-		/* As RM69090 driver need offset (see ORIENTATIONS_GENERAL) then the memory area needs to follow offsets*/
-		x0 += self->x_gap;
-		y0 += self->y_gap;
-		x1 += self->x_gap;
-		y1 += self->y_gap;
 
-		uint8_t bufx[4] = {
-			((x0 >> 8) & 0xFF),	// SC9 and SC8 are > 8 bits 
-			(x0 & 0xFF),		// SC7 to SC0 are < 8 bits
-			((x1 >> 8) & 0xFF),	// EC9 and EC8
-			(x1 & 0xFF)};		// and so
-		uint8_t bufy[4] = {
-			((y0 >> 8) & 0xFF),	// SP9 and SP8...
-			(y0 & 0xFF),
-			((y1 >> 8) & 0xFF),
-			(y1 & 0xFF)};
-		uint8_t bufz[1] = { 0x00 };
-	
-		write_spi(self, LCD_CMD_CASET, bufx, 4);
-		write_spi(self, LCD_CMD_RASET, bufy, 4);
-		write_spi(self, LCD_CMD_RAMWR, bufz, 0);  /* strict copy of Lilygo AMOLED */
+//	present([timeout_ms]) sends the damaged areas on the next TE edge, returns False if TE was not seen
+//	The TE edge is raised at the tear scanline set in init(), the panel scan then runs ahead of the transfer
+STATIC mp_obj_t amoled_AMOLED_present(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_int_t timeout_ms = (n_args > 1) ? mp_obj_get_int(args[1]) : TE_TIMEOUT_MS;
+	bool synced = false;
+
+	if (amoled_damage_pending(&self->damage)) {
+		flush_sync(self);					// previous frame must be out before waiting for the new edge
+		synced = te_wait(self, timeout_ms);
+		self->damage.bytes_naive += window_bytes(self, 0, 0, self->width, self->height);
+		flush_damage(self);
 	}
+	return mp_obj_new_bool(synced);
 }
 
-//This function send a part of the frame_buffer to the display memory
-STATIC void refresh_display(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-	
-	// The SC[9:0] must be divisible by 2 (EVEN)
-	uint16_t SC = x & 0xFE; 
-	uint16_t SR = y & 0xFE;
-	// EC[9:0]-SC[9:0]+1 must can be divisible by 2 (EVEN), As EC is EVEN SC has to be ODD
-	uint16_t EC = (x+w-1) | 0x01;
-	uint16_t ER = (y+h-1) | 0x01;
-	
-	size_t p_buf_idx;
-	size_t buf_idx;
-	
-	if (self->auto_refresh) {
-
-		uint16_t w1 = EC - SC + 1 ; // Corrected width
-		uint16_t h1 = ER - SR + 1;
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_present_obj, 1, 2, amoled_AMOLED_present);
 
-		self->partial_frame_buffer_size = w1 * h1 * 2;
-		self->partial_frame_buffer = m_malloc(self->partial_frame_buffer_size);
 
-		//Copy frame_buffer to partial_frame_buffer
-		p_buf_idx = 0;
-		for (uint16_t line = 0; line < h1; line++) {
-			buf_idx = ((SR + line) * self->width) + SC;
-			memcpy(&self->partial_frame_buffer[p_buf_idx], &self->frame_buffer[buf_idx], 2 * w1);
-			p_buf_idx += w1;
-		}
-		
-		//Set display areas and write the partial frame buffer
-		set_area(self, SC, SR, EC, ER);
-		write_color(self, self->partial_frame_buffer, self->partial_frame_buffer_size);
+//	wait_vsync([timeout_ms]) waits for the next TE edge, returns False on timeout or without te pin
+STATIC mp_obj_t amoled_AMOLED_wait_vsync(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_int_t timeout_ms = (n_args > 1) ? mp_obj_get_int(args[1]) : TE_TIMEOUT_MS;
 
-		//Than partial frame buffer  memory and return
-		m_free(self->partial_frame_buffer);
-	}
+	return mp_obj_new_bool(te_wait(self, timeout_ms));
 }
 
-STATIC mp_obj_t amoled_AMOLED_refresh(size_t n_args, const mp_obj_t *args) {
-	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-	bool save_auto_refresh = self->auto_refresh;  //Save auto_refresh value
-		
-	self->auto_refresh = true;	// Allow to write to screen buffer
-	
-	if (n_args > 4) {	//if x0..y1 exist, only update partial area
-		refresh_display(self, mp_obj_get_int(args[1]), mp_obj_get_int(args[2]), mp_obj_get_int(args[3]),  mp_obj_get_int(args[4]));
-	} else {			//otherwise update full screen
-		refresh_display(self, 0, 0, self->width, self->height);
-	}
-	self->auto_refresh = save_auto_refresh;  //Restore auto_refresh value
-	
-    return mp_const_none;
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_wait_vsync_obj, 1, 2, amoled_AMOLED_wait_vsync);
+
+
+// Returns the measured panel refresh period in us (0 until two TE edges were seen)
+STATIC mp_obj_t amoled_AMOLED_refresh_period(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	return mp_obj_new_int_from_uint(self->te_period_us);
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_refresh_obj, 1, 1, amoled_AMOLED_refresh);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_refresh_period_obj, amoled_AMOLED_refresh_period);
 
-// This fill the frame buffer area, it has no dimension check, all should be done previously
-STATIC void fill_frame_buffer(amoled_AMOLED_obj_t *self, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-	
-	size_t buf_idx;
-	
-    if (self->frame_buffer == NULL) {
+// Render target of the primitives : the rendering core (amoled_raster.c) draws into it
+STATIC amoled_surface_t *draw_target(amoled_AMOLED_obj_t *self) {
+    if (self->target->pixels == NULL) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
     }
-
-    color = (color << 16) | color;
-	
-	for (uint16_t line = 0; line < h; line++) {
-		buf_idx = ((y + line) * self->width) + x;
-		wmemset(&self->frame_buffer[buf_idx],color,w);
-	}
-
-    if ((!self->hold_display) & (self->auto_refresh)) {
-		refresh_display(self,x,y,w,h);
-	}
+    return self->target;
 }
 
 /*-----------------------------------------------------------------------------------------------------
 Below are drawing functions : Pixel, lines, rectangles, filled circles, a.s.o
 ------------------------------------------------------------------------------------------------------*/
 
-STATIC void pixel(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t color) {
-	
-	size_t buf_idx;
-	if ((x <= self->max_width_value) & (y <= self->max_height_value)) {
-		buf_idx = (y * self->width) + x;
-		self->frame_buffer[buf_idx] = color;
-		if (!self->hold_display & self->auto_refresh) {
-			refresh_display(self,x,y,1,1);
-		}
-	}
-}
-
 STATIC mp_obj_t amoled_AMOLED_pixel(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_PIXEL, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t color = mp_obj_get_int(args[3]);
 
-    pixel(self, x, y, color);
+    amoled_raster_pixel(draw_target(self), x, y, color);
+    refresh_display(self, x, y, 1, 1);
 
     return mp_const_none;
 }
@@ -575,9 +2007,16 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_pixel_obj, 4, 4, amoled
 
 STATIC mp_obj_t amoled_AMOLED_fill(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_FILL, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t color = mp_obj_get_int(args[1]);
 	
-    fill_frame_buffer(self, color, 0, 0, self->width , self->height);
+    amoled_surface_t *t = draw_target(self);
+
+    amoled_raster_fill(t, color, 0, 0, t->width, t->height);
+    refresh_display(self, 0, 0, t->width, t->height);
     
     return mp_const_none;
 }
@@ -585,208 +2024,110 @@ STATIC mp_obj_t amoled_AMOLED_fill(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_fill_obj, 2, 2, amoled_AMOLED_fill);
 
 
-STATIC void fast_hline(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t len, uint16_t color) {
-
-	if ((x <= self->max_width_value) & (y <= self->max_height_value) & (len >0)){
-		if (x + len > self->max_width_value) {
-			len = self->max_width_value - x;
-		} 
-		fill_frame_buffer(self, color, x, y, len, 1);
-	}
-}
-
 STATIC mp_obj_t amoled_AMOLED_hline(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_HLINE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t len = mp_obj_get_int(args[3]);
     uint16_t color = mp_obj_get_int(args[4]);
 
-    fast_hline(self, x, y, len, color);
+    amoled_raster_hline(draw_target(self), x, y, len, color);
+    refresh_display(self, x, y, len, 1);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_hline_obj, 5, 5, amoled_AMOLED_hline);
 
 
-STATIC void fast_vline(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t len, uint16_t color) {
-	if ((x <= self->max_width_value) & (y <= self->max_height_value) & (len >0)){
-		if (y + len > self->max_height_value) {
-			len = self->max_height_value - y;
-		} 
-		fill_frame_buffer(self, color, x, y, 1, len);
-	}
-}
-
 STATIC mp_obj_t amoled_AMOLED_vline(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_VLINE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t len = mp_obj_get_int(args[3]);
     uint16_t color = mp_obj_get_int(args[4]);
 
-    fast_vline(self, x, y, len, color);
+    amoled_raster_vline(draw_target(self), x, y, len, color);
+    refresh_display(self, x, y, 1, len);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_vline_obj, 5, 5, amoled_AMOLED_vline);
 
 
-STATIC void line(amoled_AMOLED_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
-    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
-	bool saved_hold_display = self->hold_display;
-	
-    if (steep) {
-        _swap_int16_t(x0, y0);
-        _swap_int16_t(x1, y1);
-    }
-
-    if (x0 > x1) {
-        _swap_int16_t(x0, x1);
-        _swap_int16_t(y0, y1);
-    }
-
-    int16_t dx = x1 - x0, dy = ABS(y1 - y0);
-    int16_t err = dx >> 1, ystep = -1, xs = x0, dlen = 0;
-
-    if (y0 < y1) {
-        ystep = 1;
-    }
-	
-	self->hold_display = true;
-	
-    // Split into steep and not steep for FastH/V separation
-    if (steep) {
-        for (; x0 <= x1; x0++) {
-            dlen++;
-            err -= dy;
-            if (err < 0) {
-                err += dx;
-                fast_vline(self, y0, xs, dlen, color);
-                dlen = 0;
-                y0 += ystep;
-                xs = x0 + 1;
-            }
-        }
-        if (dlen) {
-            fast_vline(self, y0, xs, dlen, color);
-        }
-    } else {
-        for (; x0 <= x1; x0++) {
-            dlen++;
-            err -= dy;
-            if (err < 0) {
-                err += dx;
-                fast_hline(self, xs, y0, dlen, color);
-                dlen = 0;
-                y0 += ystep;
-                xs = x0 + 1;
-            }
-        }
-        if (dlen) {
-            fast_hline(self, xs, y0, dlen, color);
-        }
-    }
-	// Restore hold_display status
-	self->hold_display = saved_hold_display;
-	if (!self->hold_display & self->auto_refresh) {
-		refresh_display(self,x0,y0,x1-x0,(y1>y0)?(y1-y0):(y0-y1));
-	}
-}
-
 STATIC mp_obj_t amoled_AMOLED_line(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    uint16_t x0 = mp_obj_get_int(args[1]);
-    uint16_t y0 = mp_obj_get_int(args[2]);
-    uint16_t x1 = mp_obj_get_int(args[3]);
-    uint16_t y1 = mp_obj_get_int(args[4]);
+    mp_obj_t ret = dlist_record(self, DL_LINE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
+    mp_int_t x0 = mp_obj_get_int(args[1]);
+    mp_int_t y0 = mp_obj_get_int(args[2]);
+    mp_int_t x1 = mp_obj_get_int(args[3]);
+    mp_int_t y1 = mp_obj_get_int(args[4]);
     uint16_t color = mp_obj_get_int(args[5]);
 
-    line(self, x0, y0, x1, y1, color);
+    amoled_raster_line(draw_target(self), x0, y0, x1, y1, color);
+    refresh_display(self, minx(x0, x1), minx(y0, y1), ABS(x1 - x0), ABS(y1 - y0));
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_line_obj, 6, 6, amoled_AMOLED_line);
 
 
-STATIC void rect(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-
-	if (x + w > self->width || y + h > self->height || w == 0 || h ==0) {
-		return;
-	} 
-	if (h == 1){
-		fast_hline(self, x, y, w, color);
-		return;
-	}
-	if (w == 1){
-		fast_vline(self, x, y, h, color);
-		return;
-	}
-	self->hold_display = true;
-    fast_hline(self, x, y, w, color);
-    fast_hline(self, x, y + h - 1, w, color);
-    fast_vline(self, x, y, h, color);
-    fast_vline(self, x + w - 1, y, h, color);
-	self->hold_display = false;
-	refresh_display(self,x,y,w,h);
-}
-
 STATIC mp_obj_t amoled_AMOLED_rect(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_RECT, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t w = mp_obj_get_int(args[3]);
     uint16_t h = mp_obj_get_int(args[4]);
     uint16_t color = mp_obj_get_int(args[5]);
 
-    rect(self, x, y, w, h, color);
+    amoled_raster_rect(draw_target(self), x, y, w, h, color);
+    refresh_display(self, x, y, w, h);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_rect_obj, 6, 6, amoled_AMOLED_rect);
 
 
-STATIC void fill_rect(amoled_AMOLED_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-
-	/* Check are done to see if COL and ROW START ARE EVEN and COL and ROW END minus START are also divisible by 2*/
-	if (x + w > self->width || y + h > self->height || w == 0 || h ==0) {
-		return;
-	}
-	fill_frame_buffer(self, color, x, y, w, h);
-}
-
 STATIC mp_obj_t amoled_AMOLED_fill_rect(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_FILL_RECT, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t w = mp_obj_get_int(args[3]);
     uint16_t l = mp_obj_get_int(args[4]);
     uint16_t color = mp_obj_get_int(args[5]);
 
-    fill_rect(self, x, y, w, l, color);
+    amoled_raster_fill_rect(draw_target(self), x, y, w, l, color);
+    refresh_display(self, x, y, w, l);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_fill_rect_obj, 6, 6, amoled_AMOLED_fill_rect);
 
 
-STATIC void trian(amoled_AMOLED_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color) {
-
-	uint16_t xmin = minx(minx(x0,x1),x2);
-	uint16_t xmax = maxx(maxx(x0,x1),x2);
-	uint16_t ymin = minx(minx(y0,y1),y2);
-	uint16_t ymax = maxx(maxx(y0,y1),y2);
-
-	self->hold_display = true;
-	line(self, x0, y0, x1, y1, color);
-	line(self, x1, y1, x2, y2, color);
-	line(self, x0, y0, x2, y2, color);
-	self->hold_display = false;
-	refresh_display(self,xmin,ymin,xmax-xmin,ymax-ymin);
-}
-
 STATIC mp_obj_t amoled_AMOLED_trian(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_TRIAN, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x0 = mp_obj_get_int(args[1]);
     uint16_t y0 = mp_obj_get_int(args[2]);
 	uint16_t x1 = mp_obj_get_int(args[3]);
@@ -795,81 +2136,21 @@ STATIC mp_obj_t amoled_AMOLED_trian(size_t n_args, const mp_obj_t *args) {
     uint16_t y2 = mp_obj_get_int(args[6]);
     uint16_t color = mp_obj_get_int(args[7]);
 
-    trian(self, x0, y0, x1, y1, x2, y2, color);
+    amoled_raster_trian(draw_target(self), x0, y0, x1, y1, x2, y2, color);
+    refresh_display(self, minx(minx(x0, x1), x2), minx(minx(y0, y1), y2),
+        maxx(maxx(x0, x1), x2) - minx(minx(x0, x1), x2), maxx(maxx(y0, y1), y2) - minx(minx(y0, y1), y2));
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_trian_obj, 8, 8, amoled_AMOLED_trian);
 
 
-STATIC void fill_trian(amoled_AMOLED_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color) {
-
-	uint16_t xmin = minx(minx(x0,x1),x2);
-	uint16_t xmax = maxx(maxx(x0,x1),x2);
-	mp_float_t dx02;
-	mp_float_t dx01;
-	mp_float_t dx12;
-	mp_float_t x01;
-	mp_float_t x02;
-	mp_float_t x12;
-	
-	//Sort corners by y value (y0 < y1 < y2)
-	if (y1 < y0) {
-		_swap_int16_t(x0, x1);
-        _swap_int16_t(y0, y1);
-	}
-	if (y2 < y0) {
-		_swap_int16_t(x0, x2);
-        _swap_int16_t(y0, y2);
-	}	
-	if (y2 < y1) {
-		_swap_int16_t(x1, x2);
-        _swap_int16_t(y1, y2);
-	}		
-	
-	if (y2 == y0) {
-		fast_hline(self,xmin,y0,xmax-xmin,color);
-		return;
-	}
-
-	self->hold_display = true;
-	
-	dx02 = (float)(x2 - x0) / (float)(y2 - y0);
-	x02 = x0;
-	x01 = x0;
-	/*Check if triangle has flat bottom*/
-	if (y1 > y0) {
-		dx01 = (float)(x1 - x0) / (float)(y1 - y0);
-		for(uint16_t y=y0; y<=y1; y++) {
-			if (x01 <= x02) {
-				fast_hline(self,(int)x01,y,(int)(x02-x01),color);
-			} else {
-				fast_hline(self,(int)x02,y,(int)(x01-x02),color);
-			}
-			x02 += dx02;
-			x01 += dx01;
-		}
-	}
-	/*Check if triangle has flat top*/
-	if (y2 > y1) {
-		dx12 = (float)(x2 - x1) / (float)(y2 - y1);
-		x12 = x1 + dx12; //we alreardy proceed up to y1 so 
-		for(uint16_t y=y1+1; y<=y2; y++) {
-			if (x02 <= x12) {
-				fast_hline(self,(int)x02,y,(int)(x12-x02),color);
-			} else {
-				fast_hline(self,(int)x12,y,(int)(x02-x12),color);
-			}
-			x02 += dx02;
-			x12 += dx12;		
-		}
-	}
-	self->hold_display = false;
-	refresh_display(self,xmin,y0,xmax-xmin,y2-y0);
-}
-
 STATIC mp_obj_t amoled_AMOLED_fill_trian(size_t n_args, const mp_obj_t *args) {
 	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_obj_t ret = dlist_record(self, DL_FILL_TRIAN, n_args, args);
+	if (ret != MP_OBJ_NULL) {
+		return ret;
+	}
 	uint16_t x0 = mp_obj_get_int(args[1]);
 	uint16_t y0 = mp_obj_get_int(args[2]);
 	uint16_t x1 = mp_obj_get_int(args[3]);
@@ -877,219 +2158,87 @@ STATIC mp_obj_t amoled_AMOLED_fill_trian(size_t n_args, const mp_obj_t *args) {
 	uint16_t x2 = mp_obj_get_int(args[5]);
 	uint16_t y2 = mp_obj_get_int(args[6]);
 	uint16_t color = mp_obj_get_int(args[7]);
-	fill_trian(self, x0, y0, x1, y1, x2, y2, color);
+	amoled_raster_fill_trian(draw_target(self), x0, y0, x1, y1, x2, y2, color);
+	refresh_display(self, minx(minx(x0, x1), x2), minx(minx(y0, y1), y2),
+		maxx(maxx(x0, x1), x2) - minx(minx(x0, x1), x2), maxx(maxx(y0, y1), y2) - minx(minx(y0, y1), y2));
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_fill_trian_obj, 8, 8, amoled_AMOLED_fill_trian);
 
 
-STATIC void bubble_rect(amoled_AMOLED_obj_t *self, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color) {
-    if (xs + w > self->width || ys + h > self->height) {
-        return;
-    }
-    int bubble_size;
-    if (w < h) {
-        bubble_size = w / 4;
-    } else {
-        bubble_size = h / 4;
-    }
-    
-    int xm = xs + bubble_size;
-    int ym = ys + bubble_size;
-    int x = 0;
-    int y = bubble_size;
-    int p = 1 - bubble_size;
-    
-	self->hold_display = true;
-    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
-        return;
-    } else {
-        fast_hline(self, xs + bubble_size - 1, ys, w - bubble_size * 2, color);
-        fast_hline(self, xs + bubble_size - 1, ys + h - 1, w - bubble_size * 2, color);
-        fast_vline(self, xs, ys + bubble_size - 1, h - bubble_size * 2, color);
-        fast_vline(self, xs + w -1, ys + bubble_size - 1, h - bubble_size * 2, color);
-    }
-
-    while (x <= y){
-        // top left
-        pixel(self, xm - x, ym - y, color);
-        pixel(self, xm - y, ym - x, color);
-        
-        // top right
-        pixel(self, xm + w - bubble_size * 2 + x - 1, ym - y, color);
-        pixel(self, xm + w - bubble_size * 2 + y - 1, ym - x, color);
-        
-        // bottom left
-        pixel(self, xm - x, ym + h - bubble_size * 2 + y - 1, color);
-        pixel(self, xm - y, ym + h - bubble_size * 2 + x - 1, color);
-        
-        // bottom right
-        pixel(self, xm + w - bubble_size * 2 + x - 1, ym + h - bubble_size * 2 + y - 1, color);
-        pixel(self, xm + w - bubble_size * 2 + y - 1, ym + h - bubble_size * 2 + x - 1, color);
-        
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        }
-        x += 1;
-    }
-	self->hold_display = false;
-	refresh_display(self,xs,ys,w,h);
-}
-
 STATIC mp_obj_t amoled_AMOLED_bubble_rect(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_BUBBLE_RECT, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t w = mp_obj_get_int(args[3]);
     uint16_t h = mp_obj_get_int(args[4]);
     uint16_t color = mp_obj_get_int(args[5]);
 
-    bubble_rect(self, x, y, w, h, color);
+    amoled_raster_bubble_rect(draw_target(self), x, y, w, h, color);
+    refresh_display(self, x, y, w, h);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_bubble_rect_obj, 6, 6, amoled_AMOLED_bubble_rect);
 
 
-STATIC void fill_bubble_rect(amoled_AMOLED_obj_t *self, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color) {
-    if (xs + w > self->width || ys + h > self->height) {
-        return;
-    }
-    int bubble_size;
-    if (w < h) {
-        bubble_size = w / 4;
-    } else {
-        bubble_size = h / 4;
-    }
-    
-    int xm = xs + bubble_size;
-    int ym = ys + bubble_size;
-    int x = 0;
-    int y = bubble_size;
-    int p = 1 - bubble_size;
-    
-	self->hold_display = true;
-	
-    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
-        return;
-    } else {
-        fill_rect(self, xs, ys + bubble_size - 1, w, h - bubble_size * 2, color);
-    }
-
-    while (x <= y) {
-        // top left to right
-        fast_hline(self, xm - x, ym - y, w - bubble_size * 2 + x * 2 - 1, color);
-        fast_hline(self, xm - y, ym - x, w - bubble_size * 2 + y * 2 - 1, color);
-        
-        // bottom left to right
-        fast_hline(self, xm - x, ym + h - bubble_size * 2 + y - 1, w - bubble_size * 2 + x * 2 - 1, color);
-        fast_hline(self, xm - y, ym + h - bubble_size * 2 + x - 1, w - bubble_size * 2 + y * 2 - 1, color);
-        
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        } 
-        x += 1;
-    }
-	self->hold_display = false;
-	refresh_display(self,xs,ys,w,h);
-}
-
 STATIC mp_obj_t amoled_AMOLED_fill_bubble_rect(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_FILL_BUBBLE_RECT, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t x = mp_obj_get_int(args[1]);
     uint16_t y = mp_obj_get_int(args[2]);
     uint16_t w = mp_obj_get_int(args[3]);
     uint16_t h = mp_obj_get_int(args[4]);
     uint16_t color = mp_obj_get_int(args[5]);
 
-    fill_bubble_rect(self, x, y, w, h, color);
+    amoled_raster_fill_bubble_rect(draw_target(self), x, y, w, h, color);
+    refresh_display(self, x, y, w, h);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_fill_bubble_rect_obj, 6, 6, amoled_AMOLED_fill_bubble_rect);
 
 
-STATIC void circle(amoled_AMOLED_obj_t *self, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color) {
-    int x = 0;
-    int y = r;
-    int p = 1 - r;
-
-	self->hold_display = true;
-    while (x <= y) {
-        pixel(self, xm + x, ym + y, color);
-        pixel(self, xm + x, ym - y, color);
-        pixel(self, xm - x, ym + y, color);
-        pixel(self, xm - x, ym - y, color);
-        pixel(self, xm + y, ym + x, color);
-        pixel(self, xm + y, ym - x, color);
-        pixel(self, xm - y, ym + x, color);
-        pixel(self, xm - y, ym - x, color);
-
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        }
-        x += 1;
-    }
-	self->hold_display = false;
-	refresh_display(self,xm-r,ym-r,2*r+1,2*r+1);
-}
-
 STATIC mp_obj_t amoled_AMOLED_circle(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_CIRCLE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t xm = mp_obj_get_int(args[1]);
     uint16_t ym = mp_obj_get_int(args[2]);
     uint16_t r = mp_obj_get_int(args[3]);
     uint16_t color = mp_obj_get_int(args[4]);
 
-    circle(self, xm, ym, r, color);
+    amoled_raster_circle(draw_target(self), xm, ym, r, color);
+    refresh_display(self, xm - r, ym - r, 2 * r + 1, 2 * r + 1);
     return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_circle_obj, 5, 5, amoled_AMOLED_circle);
 
 
-STATIC void fill_circle(amoled_AMOLED_obj_t *self, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color) {
-    int x = 0;
-    int y = r;
-    int p = 1 - r;
-	
-	self->hold_display = true;
-    while (x <= y) {
-        fast_vline(self, xm + x, ym - y, 2 * y, color);
-        fast_vline(self, xm - x, ym - y, 2 * y, color);
-        fast_vline(self, xm + y, ym - x, 2 * x, color);
-        fast_vline(self, xm - y, ym - x, 2 * x, color);
-
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        }
-        x += 1;
-    }
-	self->hold_display = false;
-	refresh_display(self,xm-r,ym-r,2*r+1,2*r+1);
-}
-
 STATIC mp_obj_t amoled_AMOLED_fill_circle(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_FILL_CIRCLE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint16_t xm = mp_obj_get_int(args[1]);
     uint16_t ym = mp_obj_get_int(args[2]);
     uint16_t r = mp_obj_get_int(args[3]);
     uint16_t color = mp_obj_get_int(args[4]);
 
-    fill_circle(self, xm, ym, r, color);
+    amoled_raster_fill_circle(draw_target(self), xm, ym, r, color);
+    refresh_display(self, xm - r, ym - r, 2 * r + 1, 2 * r + 1);
     return mp_const_none;
 }
 
@@ -1166,6 +2315,10 @@ STATIC void rotate_polygon(Polygon *polygon, Point center, mp_float_t angle) {
 
 STATIC mp_obj_t amoled_AMOLED_polygon(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_POLYGON, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
 
     size_t poly_len;
     mp_obj_t *polygon;
@@ -1229,12 +2382,11 @@ STATIC mp_obj_t amoled_AMOLED_polygon(size_t n_args, const mp_obj_t *args) {
                 rotate_polygon(&polygon, center, angle);
             }
 
+			amoled_surface_t *t = draw_target(self);
 			xmax = (int)point[0].x + x;
 			xmin = xmax;
 			ymax = (int)point[0].y + y;
 			ymin = ymax;
-			
-			self->hold_display = true;
 
             for (int idx = 1; idx < poly_len; idx++) {
 				x0 = (int)point[idx - 1].x + x;
@@ -1247,10 +2399,9 @@ STATIC mp_obj_t amoled_AMOLED_polygon(size_t n_args, const mp_obj_t *args) {
 				ymax = (y0>ymax) ? y0 : ymax;
 				ymin = (y0<ymin) ? y0 : ymin;
 				
-                line(self,x0,y0,x1,y1, color);
+                amoled_raster_line(t, x0, y0, x1, y1, color);
             }
 			
-			self->hold_display = false;
 			refresh_display(self,xmin,ymin,xmax-xmin,ymax-ymin);
 			
             m_free(self->work);
@@ -1268,98 +2419,12 @@ STATIC mp_obj_t amoled_AMOLED_polygon(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_polygon_obj, 5, 8, amoled_AMOLED_polygon);
 
 
-// public-domain code by Darel Rex Finley, 2007 https://alienryderflex.com/polygon_fill/ 
-STATIC void fill_polygon(amoled_AMOLED_obj_t *self, Polygon *polygon, Point location, uint16_t color) {
-    int nodes, nodeX[MAX_POLY_CORNERS], pixelY, i, j, swap;
-
-    int minX = INT_MAX;
-    int maxX = INT_MIN;
-    int minY = INT_MAX;
-    int maxY = INT_MIN;
-
-    for (i = 0; i < polygon->length; i++) {
-        if (polygon->points[i].x < minX) {
-            minX = (int)polygon->points[i].x;
-        }
-
-        if (polygon->points[i].x > maxX) {
-            maxX = (int)polygon->points[i].x;
-        }
-
-        if (polygon->points[i].y < minY) {
-            minY = (int)polygon->points[i].y;
-        }
-
-        if (polygon->points[i].y > maxY) {
-            maxY = (int)polygon->points[i].y;
-        }
-    }
-
-	self->hold_display = true;
-    //  Loop through the rows
-    for (pixelY = minY; pixelY < maxY; pixelY++) {
-        //  Build a list of nodes.
-        nodes = 0;
-        j = polygon->length - 1;
-        for (i = 0; i < polygon->length; i++) {
-            if ((polygon->points[i].y < pixelY && polygon->points[j].y >= pixelY) ||
-                (polygon->points[j].y < pixelY && polygon->points[i].y >= pixelY)) {
-                if (nodes < MAX_POLY_CORNERS) {
-                    nodeX[nodes++] = (int)(polygon->points[i].x +
-                        (pixelY - polygon->points[i].y) /
-                        (polygon->points[j].y - polygon->points[i].y) *
-                        (polygon->points[j].x - polygon->points[i].x));
-                } else {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon too complex increase MAX_POLY_CORNERS."));
-                }
-            }
-            j = i;
-        }
-
-        //  Sort the nodes, via a simple “Bubble” sort.
-        i = 0;
-        while (i < nodes - 1) {
-            if (nodeX[i] > nodeX[i + 1]) {
-                swap = nodeX[i];
-                nodeX[i] = nodeX[i + 1];
-                nodeX[i + 1] = swap;
-                if (i) {
-                    i--;
-                }
-            } else {
-                i++;
-            }
-        }		
-        //  Fill the pixels between node pairs.
-        for (i = 0; i < nodes; i += 2) {
-            if (nodeX[i] >= maxX) {
-                break;
-            }
-
-            if (nodeX[i + 1] > minX) {
-                if (nodeX[i] < minX) {
-                    nodeX[i] = minX;
-                }
-
-                if (nodeX[i + 1] > maxX) {
-                    nodeX[i + 1] = maxX;
-                }
-
-                fast_hline(self, (int)location.x + nodeX[i], (int)location.y + pixelY, nodeX[i + 1] - nodeX[i] + 1, color);
-            }
-        }
-    }
-	/*Adjust display refresh*/
-	minX = minX + (int)location.x;
-    maxX = maxX + (int)location.x;
-    minY = minY + (int)location.y;
-    maxY = maxY + (int)location.y;
-	self->hold_display = false;	
-	refresh_display(self,minX,minY,maxX - minX,maxY - minY);
-}
-
 STATIC mp_obj_t amoled_AMOLED_fill_polygon(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_FILL_POLYGON, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
 
     size_t poly_len;
     mp_obj_t *polygon;
@@ -1408,8 +2473,21 @@ STATIC mp_obj_t amoled_AMOLED_fill_polygon(size_t n_args, const mp_obj_t *args)
                 rotate_polygon(&polygon, center, angle);
             }
 
-            Point location = {x, y};
-            fill_polygon(self, &polygon, location, color);
+            // the rendering core fills the points offset by x, y
+            bool done = amoled_raster_fill_polygon(draw_target(self), polygon.points, polygon.length, x, y, color);
+            if (!done) {
+                m_free(self->work);
+                self->work = NULL;
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon too complex increase AMOLED_RASTER_MAX_POLY_CORNERS."));
+            }
+            int xmin = INT_MAX, xmax = INT_MIN, ymin = INT_MAX, ymax = INT_MIN;
+            for (int idx = 0; idx < poly_len; idx++) {
+                xmin = MIN(xmin, (int)point[idx].x);
+                xmax = MAX(xmax, (int)point[idx].x);
+                ymin = MIN(ymin, (int)point[idx].y);
+                ymax = MAX(ymax, (int)point[idx].y);
+            }
+            refresh_display(self, x + xmin, y + ymin, xmax - xmin, ymax - ymin);
 
             m_free(self->work);
             self->work = NULL;
@@ -1430,6 +2508,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_fill_polygon_obj, 5, 8,
 Below are bitmap related functions
 ------------------------------------------------------------------------------------------------------*/
 
+// Not recorded in the display list : on the screen it writes the display memory, not the frame buffer replay draws into
 STATIC mp_obj_t amoled_AMOLED_bitmap(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
 
@@ -1438,16 +2517,35 @@ STATIC mp_obj_t amoled_AMOLED_bitmap(size_t n_args, const mp_obj_t *args) {
     int x_end   = mp_obj_get_int(args[3]);
     int y_end   = mp_obj_get_int(args[4]);
 
-    x_start += self->x_gap;
-    x_end += self->x_gap;
-    y_start += self->y_gap;
-    y_end += self->y_gap;
+    if (self->transpose || (self->target != &self->screen)) {
+        // a Surface, or display memory not laid out like the buffer : go through the render target
+        if (self->target->pixel_bits != 16) {
+            mp_raise_ValueError(MP_ERROR_TEXT("bitmap needs a RGB565 frame buffer in this rotation"));
+        }
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[5], &bufinfo, MP_BUFFER_READ);
+        if ((x_start < 0) || (y_start < 0) || (x_end < x_start) || (y_end < y_start) ||
+            (x_end >= self->target->width) || (y_end >= self->target->height)) {
+            return mp_const_none;
+        }
+        int w = x_end - x_start + 1;
+        int h = y_end - y_start + 1;
+        if ((size_t)(h * w * 2) > bufinfo.len) {
+            h = bufinfo.len / (2 * w);
+        }
+        amoled_raster_copy(draw_target(self), x_start, y_start, w, h, bufinfo.buf);
+        refresh_display(self, x_start, y_start, w, h);
+        return mp_const_none;
+    }
 
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(args[5], &bufinfo, MP_BUFFER_READ);
-    set_area(self, x_start, y_start, x_end, y_end);
-    size_t len = ((x_end - x_start) * (y_end - y_start) * self->fb_bpp / 8);
-    write_color(self, bufinfo.buf, len);
+    flush_sync(self);               // set_area does not wait for the flush worker
+    set_area(self, SELF_STATS(self), x_start, y_start, x_end, y_end);     // set_area adds the gaps
+    // buf holds the window pixels in the panel format : 2 bytes in RGB565, 3 in RGB666 / RGB888
+    size_t len = (x_end - x_start + 1) * (y_end - y_start + 1) * self->bus_pixel_bytes;
+    write_color(self, bufinfo.buf, (len < bufinfo.len) ? len : bufinfo.len);
+    self->shadow_valid = false;     // display memory no longer matches the shadow frame until refresh() resends it all
 
     return mp_const_none;
 }
@@ -1455,21 +2553,64 @@ STATIC mp_obj_t amoled_AMOLED_bitmap(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_bitmap_obj, 6, 6, amoled_AMOLED_bitmap);
 
 
-STATIC uint32_t bs_bit = 0;
-uint8_t *bitmap_data = NULL;
+// Surface, key and alpha arguments of blit() : pixels equal to key are not copied, the others are blended with alpha
+STATIC amoled_surface_t *blit_args(size_t n_args, const mp_obj_t *args, int32_t *key, uint8_t *alpha) {
+	if (!mp_obj_is_type(args[0], &amoled_surface_type)) {
+		mp_raise_TypeError(MP_ERROR_TEXT("blit source must be a Surface"));
+	}
+	*key = ((n_args > 3) && (args[3] != mp_const_none)) ? (mp_obj_get_int(args[3]) & 0xFFFF) : -1;
+	mp_int_t a = (n_args > 4) ? mp_obj_get_int(args[4]) : 255;
+	if ((a < 0) || (a > 255)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("alpha must be 0 to 255"));
+	}
+	*alpha = a;
+	return &((amoled_surface_obj_t *)MP_OBJ_TO_PTR(args[0]))->surface;
+}
+
+//	blit(surface, x, y[, key, alpha]) copies a Surface to x, y of the render target (the screen or the selected Surface)
+STATIC mp_obj_t amoled_AMOLED_blit(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_obj_t ret = dlist_record(self, DL_BLIT, n_args, args);
+	if (ret != MP_OBJ_NULL) {
+		return ret;
+	}
+	int32_t key;
+	uint8_t alpha;
+	amoled_surface_t *src = blit_args(n_args - 1, &args[1], &key, &alpha);
+	amoled_area_t area;
+
+	if (self->target->pixel_bits != 16) {
+		mp_raise_ValueError(MP_ERROR_TEXT("blit needs a RGB565 frame buffer"));
+	}
+	if (amoled_raster_blit(draw_target(self), src, mp_obj_get_int(args[2]), mp_obj_get_int(args[3]), key, alpha, &area)) {
+		refresh_display(self, area.x0, area.y0, area.x1 - area.x0 + 1, area.y1 - area.y0 + 1);
+	}
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_blit_obj, 4, 6, amoled_AMOLED_blit);
 
-STATIC uint8_t get_color(uint8_t bpp) {
-    uint8_t color = 0;
-    int i;
 
-    for (i = 0; i < bpp; i++) {
-        color <<= 1;
-        color |= (bitmap_data[bs_bit / 8] & 1 << (7 - (bs_bit % 8))) > 0;
-        bs_bit++;
-    }
-    return color;
+//	target([surface]) makes the primitives draw into surface, or back into the frame buffer without argument
+//	Nothing is damaged nor sent while a Surface is the target, and the display list does not record
+STATIC mp_obj_t amoled_AMOLED_target(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+	if ((n_args < 2) || (args[1] == mp_const_none)) {
+		self->target = &self->screen;
+		self->target_obj = MP_OBJ_NULL;
+	} else if (mp_obj_is_type(args[1], &amoled_surface_type)) {
+		self->target = &((amoled_surface_obj_t *)MP_OBJ_TO_PTR(args[1]))->surface;
+		self->target_obj = args[1];
+	} else {
+		mp_raise_TypeError(MP_ERROR_TEXT("target must be a Surface or None"));
+	}
+	return mp_const_none;
 }
 
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_target_obj, 1, 2, amoled_AMOLED_target);
+
+
 /*-----------------------------------------------------------------------------------------------------
 Below are text related functions: text, write and draw
 ------------------------------------------------------------------------------------------------------*/
@@ -1477,10 +2618,13 @@ Below are text related functions: text, write and draw
 //	text(font_module, s, x, y[, fg, bg])
 STATIC mp_obj_t amoled_AMOLED_text(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_TEXT, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     uint8_t single_char_s;
     const uint8_t *source = NULL;
     size_t source_len = 0;
-	size_t buf_idx;
 
     // extract arguments
     mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);  		// Arg n°1 is the font pointer (font)
@@ -1517,7 +2661,7 @@ STATIC mp_obj_t amoled_AMOLED_text(size_t n_args, const mp_obj_t *args) {
     mp_obj_t font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));						// font_data_buff is the font buff
     mp_buffer_info_t bufinfo;																			// bufinfo is the buffer interrupt
     mp_get_buffer_raise(font_data_buff, &bufinfo, MP_BUFFER_READ);										// 
-    const uint8_t *font_data = bufinfo.buf;																// font_data is bufinfo.buf data pointer  
+    amoled_font_t font_desc = { bufinfo.buf, width, height, first, last };								// font as the rendering core sees it
 
     uint16_t fg_color;
     uint16_t bg_color;
@@ -1534,34 +2678,7 @@ STATIC mp_obj_t amoled_AMOLED_text(size_t n_args, const mp_obj_t *args) {
         bg_color = BLACK;
     }
 
-    uint8_t wide = width / 8; // wide = width in Bytes for a single char (ex 16bit large font is 2 bytes per line)
-    uint8_t chr;
-	
-    while (source_len--) {	// for the full source (in bytes)
-        chr = *source++;	// for every characteres in string as char
-        if (chr >= first && chr <= last) {	// if string character is in the font character range 
-			if (x + width > self->max_width_value) {
-				return mp_const_none;  // return if char is away from dsplay
-			}
-            uint16_t chr_idx = (chr - first) * (height * wide);	// chr_index is the charactere index in the font file 
-			for (uint8_t line = 0; line < height; line++) {		// for every line of the font character
-				buf_idx = (y + line) * self->width + x;	// buf_idx is the frame buffer start index for each line
-				for (uint8_t line_byte = 0; line_byte < wide; line_byte++) { 	//for wide bytes of every line 
-                    uint8_t chr_data = font_data[chr_idx];					 	// get corresponding data
-                    for (uint8_t bit = 8; bit; bit--) {						 	// for every bits of the font
-						if (chr_data >> (bit - 1) & 1) {	// 1 = Front color / 0 = back_color
-                            self->frame_buffer[buf_idx] = fg_color;	
-                        } else {
-                            self->frame_buffer[buf_idx] = bg_color;
-                        }
-                        buf_idx++;	// next frame buffer index and proceed next font bit
-                    }
-                    chr_idx++;													// next font line_byte
-                }																			
-            }																// next line
-            x += width;				// next chart ==> x0 moves to next place
-        }	// if not in font character range = Do nothing
-    } // all source character proceeded
+    x = amoled_raster_text(draw_target(self), &font_desc, source, source_len, x, y, fg_color, bg_color);
 	refresh_display(self,x0,y,x - x0,height);
     return mp_const_none;
 }
@@ -1611,8 +2728,11 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_text_len_obj, 3, 3, amo
 //	write(font_module, s, x, y[, fg, bg, background_tuple, fill]) with background_tuple (bitmap_buffer, width, height)
 STATIC mp_obj_t amoled_AMOLED_write(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_WRITE, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
-	size_t buf_idx;
 
     mp_int_t x = mp_obj_get_int(args[3]);
 	mp_int_t x0 = x;
@@ -1663,7 +2783,12 @@ STATIC mp_obj_t amoled_AMOLED_write(size_t n_args, const mp_obj_t *args) {
     mp_obj_t bitmaps_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS));
     mp_buffer_info_t bitmaps_bufinfo;
     mp_get_buffer_raise(bitmaps_data_buff, &bitmaps_bufinfo, MP_BUFFER_READ);
-    bitmap_data = bitmaps_bufinfo.buf; //bitmap_data is background data
+
+    amoled_pfont_t font_desc = {
+        bitmaps_bufinfo.buf, widths_data, offsets_data, offset_width, height, bpp,
+        background_data, background_width, background_height
+    };
+    amoled_surface_t *t = draw_target(self);
 
     // if fill is set, and background bitmap data is available copy the background
     // bitmap data into the buffer. The background buffer must be the size of the
@@ -1690,50 +2815,12 @@ STATIC mp_obj_t amoled_AMOLED_write(size_t n_args, const mp_obj_t *args) {
             map_ch = utf8_get_char(map_s);
             map_s = utf8_next_char(map_s);
 
-			buf_idx = 0;  // Init buffer index
-				
             if (ch == map_ch) {
-                uint8_t width = widths_data[char_index];    //width is the character width
-				if (x + width > self->max_width_value) {
-					return mp_const_none;  // return if char is away from dsplay
-				}
-                bs_bit = 0;
-                switch (offset_width) {
-                    case 1:
-                        bs_bit = offsets_data[char_index * offset_width];
-                        break;
-
-                    case 2:
-                        bs_bit = (offsets_data[char_index * offset_width] << 8) +
-                            (offsets_data[char_index * offset_width + 1]);
-                        break;
-
-                    case 3:
-                        bs_bit = (offsets_data[char_index * offset_width] << 16) +
-                            (offsets_data[char_index * offset_width + 1] << 8) +
-                            (offsets_data[char_index * offset_width + 2]);
-                        break;
+                if (!amoled_raster_glyph(t, &font_desc, char_index, x, y, fg_color, bg_color)) {
+                    top = s;    // char is away from display, stop there
+                    break;
                 }
-
-                uint16_t color = 0;
-							
-                for (uint16_t line = 0; line < height; line++) {  // for every line of char	
-					buf_idx = (y + line) * self->width + x;	// buf_idx is the frame buffer start index for each line
-                    for (uint16_t line_bits = 0; line_bits < width; line_bits++) { //for every bit of every line
-                        if (background_data && (line_bits <= background_width && line <= background_height)) {
-                            if (get_color(bpp) == bg_color) {
-                                color = background_data[(line * background_width + line_bits)];
-                            } else {
-                                color = fg_color;
-                            }
-                        } else {
-                            color = get_color(bpp) ? fg_color : bg_color;  //color = front_color else back_color
-                        }
-                        self->frame_buffer[buf_idx] = color;
-						buf_idx++;
-                    }
-				}			
-                x += width;
+                x += widths_data[char_index];	// width is the character width
                 break;
             }
             char_index++;
@@ -1791,6 +2878,10 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_write_len_obj, 3, 3, am
 //	draw(font_module, s, x, y[, fg, bg])
 STATIC mp_obj_t amoled_AMOLED_draw(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t ret = dlist_record(self, DL_DRAW, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
     char single_char_s[] = {0, 0};
     const char *s;
 
@@ -1830,55 +2921,9 @@ STATIC mp_obj_t amoled_AMOLED_draw(size_t n_args, const mp_obj_t *args) {
     mp_get_buffer_raise(font_data_buff, &font_bufinfo, MP_BUFFER_READ);
     int8_t *font = font_bufinfo.buf;
 
-    int16_t from_x = x;
-    int16_t from_y = y;
-    int16_t to_x = x;
-    int16_t to_y = y;
-    int16_t pos_x = x;
-    int16_t pos_y = y;
-    bool penup = true;
-    char c;
-    int16_t ii;
-
-    while ((c = *s++)) {
-        if (c >= 32 && c <= 127) {
-            ii = (c - 32) * 2;
-
-            int16_t offset = index[ii] | (index[ii + 1] << 8);
-            int16_t length = font[offset++];
-            int16_t left = (int)(scale * (font[offset++] - 0x52) + 0.5);
-            int16_t right = (int)(scale * (font[offset++] - 0x52) + 0.5);
-            int16_t width = right - left;
-
-            if (length) {
-                int16_t i;
-                for (i = 0; i < length; i++) {
-                    if (font[offset] == ' ') {
-                        offset += 2;
-                        penup = true;
-                        continue;
-                    }
-
-                    int16_t vector_x = (int)(scale * (font[offset++] - 0x52) + 0.5);
-                    int16_t vector_y = (int)(scale * (font[offset++] - 0x52) + 0.5);
-
-                    if (!i || penup) {
-                        from_x = pos_x + vector_x - left;
-                        from_y = pos_y + vector_y;
-                    } else {
-                        to_x = pos_x + vector_x - left;
-                        to_y = pos_y + vector_y;
-
-                        line(self, from_x, from_y, to_x, to_y, color);
-                        from_x = to_x;
-                        from_y = to_y;
-                    }
-                    penup = false;
-                }
-            }
-            pos_x += width;
-        }
-    }
+    amoled_raster_draw(draw_target(self), index, font, s, x, y, color, scale);
+    // the strokes were recorded as damaged, the glyph boxes are not known here
+    refresh_display(self, 0, 0, self->width, self->height);
 
     return mp_const_none;
 }
@@ -1947,14 +2992,10 @@ Below are JPG related functions.
 -----------------------------------------------------------------------------------------------------*/
 
 // User defined device identifier
+// out is first : the output functions of the rendering core see the device as an amoled_jpg_out_t
 typedef struct {
+    amoled_jpg_out_t out;       // picture buffer and crop window of the output functions
     mp_file_t *fp;              // File pointer for input function
-    uint8_t *fbuf;              // Pointer to the frame buffer for output function
-    unsigned int wfbuf;         // Width of the frame buffer [pix]
-    unsigned int left;          // jpg crop left column
-    unsigned int top;           // jpg crop top row
-    unsigned int right;         // jpg crop right column
-    unsigned int bottom;        // jpg crop bottom row
     amoled_AMOLED_obj_t *self;  // display object
     // for buffer input function
     uint8_t *data;
@@ -1983,34 +3024,16 @@ STATIC unsigned int in_func(JDEC *jd, uint8_t *buff, unsigned int nbyte) {
     return 0;
 }
 
-// fast output function
-// returns 1:Ok, 0:Aborted
-// jd = Decompression object
-// bitmap = Bitmap data to be output
-// rect = Rectangular region of output image
-
-STATIC int out_fast(JDEC *jd,void *bitmap, JRECT *rect) {
-    IODEV *dev = (IODEV *)jd->device;
-    uint8_t *src, *dst;
-    uint16_t y, bws, bwd;
-
-    // Copy the decompressed RGB rectangular to the frame buffer (assuming RGB565)
-    src = (uint8_t *)bitmap;
-    dst = dev->fbuf + 2 * (rect->top * dev->wfbuf + rect->left);    // Left-top of destination rectangular assuming 16bpp = 2 bytes
-    bws = 2 * (rect->right - rect->left + 1);                       // Width of source rectangular [byte]
-    bwd = 2 * dev->wfbuf;                                           // Width of frame buffer [byte]
-    for (y = rect->top; y <= rect->bottom; y++) {
-        memcpy(dst, src, bws);                                      // Copy a line
-        src += bws;
-        dst += bwd;                                                 // Next line
-    }
-    return 1;     // Continue to decompress
-}
-
-
 // Draw jpg from a file at x, y
 STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    if (self->target->pixel_bits != 16) {
+        mp_raise_ValueError(MP_ERROR_TEXT("jpg needs a RGB565 frame buffer"));
+    }
+    mp_obj_t ret = dlist_record(self, DL_JPG, n_args, args);
+    if (ret != MP_OBJ_NULL) {
+        return ret;
+    }
 	const char *filename = mp_obj_str_get_str(args[1]);
 	mp_int_t x = mp_obj_get_int(args[2]);
 	mp_int_t y = mp_obj_get_int(args[3]);
@@ -2032,7 +3055,7 @@ STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
 		if (res == JDR_OK) {
 			// Initialize output device
 			bufsize = 2 * jdec.width * jdec.height;
-			outfunc = out_fast;
+			outfunc = amoled_jpg_out_fast;
 			
 			if (self->buffer_size && (bufsize > self->buffer_size)) {
 				mp_raise_msg_varg(&mp_type_OSError, MP_ERROR_TEXT("buffer too small. %ld bytes required."), (long) bufsize);
@@ -2045,9 +3068,9 @@ STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
 			if (!self->pixel_buffer)
 				mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("out of memory"));
 
-			devid.fbuf	= (uint8_t *) self->pixel_buffer;
+			devid.out.fbuf	= (uint8_t *) self->pixel_buffer;
 			//devid.fbuf	= (uint16_t *) self->pixel_buffer;
-			devid.wfbuf = jdec.width;
+			devid.out.wfbuf = jdec.width;
 			devid.self	= self;
 			res			= jd_decomp(&jdec, outfunc, 0); // Start to decompress with 1/1 scaling
 			
@@ -2055,19 +3078,8 @@ STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
 				//set_window(self, x, y, x + jdec.width - 1, y + jdec.height - 1);
 				//write_bus(self, (uint8_t *) self->pixel_buffer, bufsize);
 				
-				size_t jpg_idx=0;
-				size_t buf_idx=0;
-				uint16_t color;
-				
-				for(uint16_t line=0; line < jdec.height; line++) {
-					buf_idx = (y + line)*self->width + x;
-					for(uint16_t col=0; col < jdec.width; col++) {
-						color = devid.fbuf[jpg_idx+1] << 8 | devid.fbuf[jpg_idx];
-						self->frame_buffer[buf_idx] = color;
-						buf_idx++;
-						jpg_idx += 2;
-					}
-				}
+				// fbuf holds the RGB565 pixels in frame buffer order
+				amoled_raster_copy(draw_target(self), x, y, jdec.width, jdec.height, (const uint16_t *)devid.out.fbuf);
 			} else {
 				mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg decompress failed."));
 			}
@@ -2075,7 +3087,7 @@ STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
 				m_free(self->pixel_buffer); // Discard frame buffer
 				self->pixel_buffer = MP_OBJ_NULL;
 			}
-			devid.fbuf = MP_OBJ_NULL;
+			devid.out.fbuf = MP_OBJ_NULL;
 		} else {
 			mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg prepare failed."));
 		}
@@ -2091,38 +3103,6 @@ STATIC mp_obj_t amoled_AMOLED_jpg(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_jpg_obj, 4, 4, amoled_AMOLED_jpg);
 
 
-// output function for jpg_decode
-// Retuns 1:Ok, 0:Aborted
-// jd = Decompression object
-// bitmap = Bitmap data to be output
-// rect = Rectangular region of output image
-
-STATIC int out_crop(JDEC *jd, void *bitmap, JRECT *rect) {                      
-    IODEV *dev = (IODEV *)jd->device;
-
-    if (dev->left <= rect->right &&
-        dev->right >= rect->left &&
-        dev->top <= rect->bottom &&
-        dev->bottom >= rect->top) {
-			uint16_t left = MAX(dev->left, rect->left);
-			uint16_t top = MAX(dev->top, rect->top);
-			uint16_t right = MIN(dev->right, rect->right);
-			uint16_t bottom = MIN(dev->bottom, rect->bottom);
-			uint16_t dev_width = dev->right - dev->left + 1;
-			uint16_t rect_width = rect->right - rect->left + 1;
-			uint16_t width = (right - left + 1) * 2;
-			uint16_t row;
-
-			for (row = top; row <= bottom; row++) {
-				memcpy(
-					(uint16_t *)dev->fbuf + ((row - dev->top) * dev_width) + left - dev->left,
-					(uint16_t *)bitmap + ((row - rect->top) * rect_width) + left - rect->left,
-					width);
-			}
-	}
-    return 1;     // Continue to decompress
-}
-
 // Decode a jpg file and return it or a portion of it as a tuple containing a blittable buffer, the width and height of the buffer.
 STATIC mp_obj_t amoled_AMOLED_jpg_decode(size_t n_args, const mp_obj_t *args) {
     amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -2157,10 +3137,10 @@ STATIC mp_obj_t amoled_AMOLED_jpg_decode(size_t n_args, const mp_obj_t *args) {
 					height = jdec.height;
 				}
 				// Initialize output device
-				devid.left	 = x;
-				devid.top	 = y;
-				devid.right	 = x + width - 1;
-				devid.bottom = y + height - 1;
+				devid.out.left	 = x;
+				devid.out.top	 = y;
+				devid.out.right	 = x + width - 1;
+				devid.out.bottom = y + height - 1;
 
 				bufsize			   = 2 * width * height;
 				self->pixel_buffer = m_malloc(bufsize);
@@ -2170,10 +3150,10 @@ STATIC mp_obj_t amoled_AMOLED_jpg_decode(size_t n_args, const mp_obj_t *args) {
 					mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("out of memory"));
 				}
 
-				devid.fbuf	= (uint8_t *) self->pixel_buffer;
-				devid.wfbuf = jdec.width;
+				devid.out.fbuf	= (uint8_t *) self->pixel_buffer;
+				devid.out.wfbuf = jdec.width;
 				devid.self	= self;
-				res			= jd_decomp(&jdec, out_crop, 0); // Start to decompress with 1/1 scaling
+				res			= jd_decomp(&jdec, amoled_jpg_out_crop, 0); // Start to decompress with 1/1 scaling
 				if (res != JDR_OK) {
 					mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg decompress failed."));
 				}
@@ -2360,6 +3340,7 @@ STATIC mp_obj_t amoled_AMOLED_vscroll_area(size_t n_args, const mp_obj_t *args)
     mp_int_t vsa = mp_obj_get_int(args[2]);
     mp_int_t bfa = mp_obj_get_int(args[3]);
 
+    scroll_reset(self);     // a raw scroll definition does not keep the ring addressing
     write_spi(
             self,
             LCD_CMD_VSCRDEF,
@@ -2405,6 +3386,10 @@ STATIC mp_obj_t amoled_AMOLED_vscroll_start(size_t n_args, const mp_obj_t *args)
         (uint8_t []) { (vssa) >> 8, (vssa) & 0xFF },
         2
     );
+    // keep the ring addressing in step with the panel
+    if (self->screen.scroll_rows) {
+        self->screen.scroll_offset = mod(vssa - self->y_gap - self->screen.scroll_top, self->screen.scroll_rows);
+    }
 
     return mp_const_none;
 }
@@ -2412,6 +3397,294 @@ STATIC mp_obj_t amoled_AMOLED_vscroll_start(size_t n_args, const mp_obj_t *args)
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_vscroll_start_obj, 2, 3, amoled_AMOLED_vscroll_start);
 
 
+//	scroll_area([top, rows]) makes rows top to top + rows - 1 a hardware scrolled region
+//	The frame buffer rows of the region are then ring addressed like the panel memory : drawing keeps
+//	using screen coordinates and scroll() only sends the rows it uncovers. No argument stops it.
+STATIC mp_obj_t amoled_AMOLED_scroll_area(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+	scroll_reset(self);
+	if (n_args < 3) {
+		return mp_const_none;
+	}
+	mp_int_t top = mp_obj_get_int(args[1]);
+	mp_int_t rows = mp_obj_get_int(args[2]);
+	if (rows == 0) {
+		return mp_const_none;
+	}
+	if ((top < 0) || (rows < 2) || (top + rows > self->height)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("scroll area out of screen"));
+	}
+	if (!scroll_supported(self)) {
+		mp_raise_ValueError(MP_ERROR_TEXT("scrolling not supported in this rotation"));
+	}
+	// the panel memory has the gap rows above and below the screen
+	int total = self->height + 2 * self->y_gap;
+	int tfa = top + self->y_gap;
+	int bfa = total - tfa - rows;
+	write_spi(self, LCD_CMD_VSCRDEF, (uint8_t []) { tfa >> 8, tfa & 0xFF, rows >> 8, rows & 0xFF, bfa >> 8, bfa & 0xFF }, 6);
+	self->screen.scroll_top = top;
+	self->screen.scroll_rows = rows;
+	self->screen.scroll_offset = 0;
+	scroll_write_start(self);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_scroll_area_obj, 1, 3, amoled_AMOLED_scroll_area);
+
+
+//	scroll(dy[, color]) moves the scroll area content up by dy rows (down if dy < 0)
+//	Costs one register write and the uncovered rows, filled with color (BLACK by default)
+STATIC mp_obj_t amoled_AMOLED_scroll(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	mp_int_t dy = mp_obj_get_int(args[1]);
+	uint16_t color = (n_args > 2) ? mp_obj_get_int(args[2]) : BLACK;
+	int rows = self->screen.scroll_rows;
+
+	if (rows == 0) {
+		mp_raise_ValueError(MP_ERROR_TEXT("no scroll area"));
+	}
+	if (self->screen.pixels == NULL) {
+		mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
+	}
+	if (dy == 0) {
+		return mp_const_none;
+	}
+	// inside a batch the panel would show the wrapped rows until the end : the start moves with the next flush
+	self->screen.scroll_offset = mod(self->screen.scroll_offset + dy, rows);
+	self->scroll_pending = true;
+
+	int count = (ABS(dy) < rows) ? ABS(dy) : rows;
+	int y = (dy > 0) ? self->screen.scroll_top + rows - count : self->screen.scroll_top;
+	amoled_raster_fill(&self->screen, color, 0, y, self->width, count);
+	if (self->auto_refresh && !self->hold_display) {
+		self->damage.bytes_naive += window_bytes(self, 0, y, self->width, count);
+		flush_damage(self);
+	}
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_scroll_obj, 2, 3, amoled_AMOLED_scroll);
+
+
+/*-----------------------------------------------------------------------------------------------------
+Below are display list related functions
+------------------------------------------------------------------------------------------------------*/
+
+// Recorded drawing calls are replayed through the Python methods themselves
+STATIC const mp_obj_t dlist_ops[DL_OPS] = {
+	[DL_PIXEL]            = MP_ROM_PTR(&amoled_AMOLED_pixel_obj),
+	[DL_FILL]             = MP_ROM_PTR(&amoled_AMOLED_fill_obj),
+	[DL_HLINE]            = MP_ROM_PTR(&amoled_AMOLED_hline_obj),
+	[DL_VLINE]            = MP_ROM_PTR(&amoled_AMOLED_vline_obj),
+	[DL_LINE]             = MP_ROM_PTR(&amoled_AMOLED_line_obj),
+	[DL_RECT]             = MP_ROM_PTR(&amoled_AMOLED_rect_obj),
+	[DL_FILL_RECT]        = MP_ROM_PTR(&amoled_AMOLED_fill_rect_obj),
+	[DL_TRIAN]            = MP_ROM_PTR(&amoled_AMOLED_trian_obj),
+	[DL_FILL_TRIAN]       = MP_ROM_PTR(&amoled_AMOLED_fill_trian_obj),
+	[DL_BUBBLE_RECT]      = MP_ROM_PTR(&amoled_AMOLED_bubble_rect_obj),
+	[DL_FILL_BUBBLE_RECT] = MP_ROM_PTR(&amoled_AMOLED_fill_bubble_rect_obj),
+	[DL_CIRCLE]           = MP_ROM_PTR(&amoled_AMOLED_circle_obj),
+	[DL_FILL_CIRCLE]      = MP_ROM_PTR(&amoled_AMOLED_fill_circle_obj),
+	[DL_POLYGON]          = MP_ROM_PTR(&amoled_AMOLED_polygon_obj),
+	[DL_FILL_POLYGON]     = MP_ROM_PTR(&amoled_AMOLED_fill_polygon_obj),
+	[DL_TEXT]             = MP_ROM_PTR(&amoled_AMOLED_text_obj),
+	[DL_WRITE]            = MP_ROM_PTR(&amoled_AMOLED_write_obj),
+	[DL_DRAW]             = MP_ROM_PTR(&amoled_AMOLED_draw_obj),
+	[DL_JPG]              = MP_ROM_PTR(&amoled_AMOLED_jpg_obj),
+	[DL_BLIT]             = MP_ROM_PTR(&amoled_AMOLED_blit_obj),
+};
+
+// Draw the commands of the display list hitting clip, clipped to it
+// Primitives only write the frame buffer, the caller sends the result
+STATIC void dlist_replay(amoled_AMOLED_obj_t *self, const amoled_area_t *clip) {
+	amoled_dlist_t *dl = &self->dlist;
+
+	if (self->target != &self->screen) {
+		mp_raise_ValueError(MP_ERROR_TEXT("replay draws on screen, select it with target()"));
+	}
+	mp_obj_t argv[AMOLED_DLIST_MAX_ARGS + 1];
+	bool saved_auto_refresh = self->auto_refresh;
+	bool saved_recording = dl->recording;
+	size_t pos = 0;
+	amoled_dl_cmd_t *cmd;
+	size_t len;
+	mp_obj_t *items;
+
+	mp_obj_list_get(self->dlist_objs, &len, &items);
+	self->auto_refresh = false;
+	dl->recording = false;
+	self->screen.clip = *clip;
+
+	nlr_buf_t nlr;
+	void *exc = NULL;
+	if (nlr_push(&nlr) == 0) {
+		argv[0] = MP_OBJ_FROM_PTR(self);
+		while ((cmd = amoled_dlist_next(dl, &pos)) != NULL) {
+			if (!amoled_dlist_hit(cmd, clip)) {
+				dl->culled++;
+				continue;
+			}
+			for (uint8_t i = 0; i < cmd->nargs; i++) {
+				argv[i + 1] = (cmd->objs & (1 << i)) ? items[cmd->args[i]] : MP_OBJ_NEW_SMALL_INT(cmd->args[i]);
+			}
+			mp_call_function_n_kw(dlist_ops[cmd->op], cmd->nargs + 1, 0, argv);
+			dl->replayed++;
+		}
+		nlr_pop();
+	} else {
+		exc = nlr.ret_val;
+	}
+	// Restore the drawing state even if a command raised
+	clip_reset(self);
+	self->auto_refresh = saved_auto_refresh;
+	dl->recording = saved_recording;
+	if (exc) {
+		nlr_jump(exc);
+	}
+}
+
+//	record_start() starts recording the drawing calls in a new display list, they are still drawn
+STATIC mp_obj_t amoled_AMOLED_record_start(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+	amoled_dlist_clear(&self->dlist);
+	self->dlist_objs = mp_obj_new_list(0, NULL);
+	self->dlist.recording = true;
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_record_start_obj, amoled_AMOLED_record_start);
+
+
+//	record_stop() stops recording, returns the number of commands in the display list
+STATIC mp_obj_t amoled_AMOLED_record_stop(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+	self->dlist.recording = false;
+	return mp_obj_new_int_from_uint(self->dlist.count);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_record_stop_obj, amoled_AMOLED_record_stop);
+
+
+//	replay([x, y, w, h]) redraws the display list commands hitting the area (whole screen by default)
+//	Returns the number of commands drawn
+STATIC mp_obj_t amoled_AMOLED_replay(size_t n_args, const mp_obj_t *args) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+	amoled_area_t clip;
+	mp_int_t x = 0, y = 0, w = self->width, h = self->height;
+
+	if (n_args > 4) {
+		x = mp_obj_get_int(args[1]);
+		y = mp_obj_get_int(args[2]);
+		w = mp_obj_get_int(args[3]);
+		h = mp_obj_get_int(args[4]);
+	}
+	self->dlist.replayed = 0;
+	self->dlist.culled = 0;
+	if (amoled_damage_align(&clip, x, y, w, h, self->width, self->height)) {
+		dlist_replay(self, &clip);
+		invalidate(self, clip.x0, clip.y0, clip.x1 - clip.x0 + 1, clip.y1 - clip.y0 + 1);
+		refresh_display(self, clip.x0, clip.y0, clip.x1 - clip.x0 + 1, clip.y1 - clip.y0 + 1);
+	}
+	return mp_obj_new_int_from_uint(self->dlist.replayed);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_AMOLED_replay_obj, 1, 5, amoled_AMOLED_replay);
+
+
+// Redraw the display list in a logical area and damage it
+STATIC void replay_area(amoled_AMOLED_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+	amoled_area_t area = { .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1 };
+	dlist_replay(self, &area);
+	invalidate(self, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+// Redraw the display list in a planner window : its rows are frame buffer rows, the ones of a scroll
+// ring are mapped back to the logical rows the commands were recorded with (up to two bands)
+STATIC void replay_window(amoled_AMOLED_obj_t *self, const amoled_area_t *area) {
+	int top = self->screen.scroll_top;
+	int rows = self->screen.scroll_rows;
+	int bottom = top + rows;
+
+	if ((rows == 0) || (area->y1 < top) || (area->y0 >= bottom)) {
+		replay_area(self, area->x0, area->y0, area->x1, area->y1);
+		return;
+	}
+	if (area->y0 < top) {
+		replay_area(self, area->x0, area->y0, area->x1, top - 1);
+	}
+	if (area->y1 >= bottom) {
+		replay_area(self, area->x0, bottom, area->x1, area->y1);
+	}
+	int p0 = (area->y0 > top) ? area->y0 : top;
+	int p1 = (area->y1 < bottom - 1) ? area->y1 : bottom - 1;
+	int n = p1 - p0 + 1;
+	int l0 = top + (p0 - top + rows - self->screen.scroll_offset) % rows;
+	int first = (bottom - l0 < n) ? bottom - l0 : n;
+	replay_area(self, area->x0, l0, area->x1, l0 + first - 1);
+	if (n > first) {
+		replay_area(self, area->x0, top, area->x1, top + n - first - 1);
+	}
+}
+
+//	replay_damage() redraws the display list in the pending damaged areas only (the dirty tiles in DAMAGE_TILES mode)
+//	Returns the number of commands drawn
+STATIC mp_obj_t amoled_AMOLED_replay_damage(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	size_t count = 0, cap = AMOLED_DAMAGE_MAX_RECTS;
+	amoled_area_t *areas = m_new(amoled_area_t, cap);
+
+	// The planner windows are taken out first : replaying records new damage
+	while (amoled_damage_next(&self->damage, &areas[count], self->width, self->height)) {
+		if (++count == cap) {
+			areas = m_renew(amoled_area_t, areas, cap, cap * 2);
+			cap *= 2;
+		}
+	}
+	self->dlist.replayed = 0;
+	self->dlist.culled = 0;
+	for (size_t i = 0; i < count; i++) {
+		replay_window(self, &areas[i]);
+	}
+	m_del(amoled_area_t, areas, cap);
+	refresh_display(self, 0, 0, 0, 0);
+	return mp_obj_new_int_from_uint(self->dlist.replayed);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_replay_damage_obj, amoled_AMOLED_replay_damage);
+
+
+//	dlist_info() returns the display list size and the last replay counters as a dict
+STATIC mp_obj_t amoled_AMOLED_dlist_info(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	mp_obj_t dict = mp_obj_new_dict(0);
+
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_commands), mp_obj_new_int_from_uint(self->dlist.count));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes), mp_obj_new_int_from_uint(self->dlist.len));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_recording), mp_obj_new_bool(self->dlist.recording));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_replayed), mp_obj_new_int_from_uint(self->dlist.replayed));
+	mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_culled), mp_obj_new_int_from_uint(self->dlist.culled));
+	return dict;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_dlist_info_obj, amoled_AMOLED_dlist_info);
+
+
+//	frame_buffer() returns the frame buffer pixels (no copy), as the panel receives them in 16 bpp
+STATIC mp_obj_t amoled_AMOLED_frame_buffer(mp_obj_t self_in) {
+	amoled_AMOLED_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+	if (self->frame_buffer == NULL) {
+		mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
+	}
+	return mp_obj_new_bytearray_by_ref(self->frame_buffer_size, self->frame_buffer);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_AMOLED_frame_buffer_obj, amoled_AMOLED_frame_buffer);
+
+
 // Mapping to Micropython
 STATIC const mp_rom_map_elem_t amoled_AMOLED_locals_dict_table[] = {
     /* { MP_ROM_QSTR(MP_QSTR_custom_init),   MP_ROM_PTR(&amoled_AMOLED_custom_init_obj)   }, */
@@ -2421,6 +3694,29 @@ STATIC const mp_rom_map_elem_t amoled_AMOLED_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_init),            MP_ROM_PTR(&amoled_AMOLED_init_obj)            },
     { MP_ROM_QSTR(MP_QSTR_send_cmd),        MP_ROM_PTR(&amoled_AMOLED_send_cmd_obj)        },
     { MP_ROM_QSTR(MP_QSTR_refresh),         MP_ROM_PTR(&amoled_AMOLED_refresh_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_swap),            MP_ROM_PTR(&amoled_AMOLED_swap_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_begin),           MP_ROM_PTR(&amoled_AMOLED_begin_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_end),             MP_ROM_PTR(&amoled_AMOLED_end_obj)             },
+    { MP_ROM_QSTR(MP_QSTR_batch),           MP_ROM_PTR(&amoled_AMOLED_batch_obj)           },
+    { MP_ROM_QSTR(MP_QSTR___enter__),       MP_ROM_PTR(&amoled_AMOLED_begin_obj)           },
+    { MP_ROM_QSTR(MP_QSTR___exit__),        MP_ROM_PTR(&amoled_AMOLED_end_obj)             },
+    { MP_ROM_QSTR(MP_QSTR_stats),           MP_ROM_PTR(&amoled_AMOLED_stats_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats),     MP_ROM_PTR(&amoled_AMOLED_reset_stats_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_damage_stats),    MP_ROM_PTR(&amoled_AMOLED_damage_stats_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_damage_mode),     MP_ROM_PTR(&amoled_AMOLED_damage_mode_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_shadow_diff),     MP_ROM_PTR(&amoled_AMOLED_shadow_diff_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_palette),         MP_ROM_PTR(&amoled_AMOLED_palette_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_layer),           MP_ROM_PTR(&amoled_AMOLED_layer_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_layer_move),      MP_ROM_PTR(&amoled_AMOLED_layer_move_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_layer_show),      MP_ROM_PTR(&amoled_AMOLED_layer_show_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_layer_key),       MP_ROM_PTR(&amoled_AMOLED_layer_key_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_layer_alpha),     MP_ROM_PTR(&amoled_AMOLED_layer_alpha_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_layer_update),    MP_ROM_PTR(&amoled_AMOLED_layer_update_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_wait),            MP_ROM_PTR(&amoled_AMOLED_wait_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_busy),            MP_ROM_PTR(&amoled_AMOLED_busy_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_present),         MP_ROM_PTR(&amoled_AMOLED_present_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_wait_vsync),      MP_ROM_PTR(&amoled_AMOLED_wait_vsync_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_refresh_period),  MP_ROM_PTR(&amoled_AMOLED_refresh_period_obj)  },
     { MP_ROM_QSTR(MP_QSTR_pixel),           MP_ROM_PTR(&amoled_AMOLED_pixel_obj)           },
     { MP_ROM_QSTR(MP_QSTR_fill),            MP_ROM_PTR(&amoled_AMOLED_fill_obj)            },
 	{ MP_ROM_QSTR(MP_QSTR_line),            MP_ROM_PTR(&amoled_AMOLED_line_obj)            },
@@ -2439,6 +3735,8 @@ STATIC const mp_rom_map_elem_t amoled_AMOLED_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_polygon_center),  MP_ROM_PTR(&amoled_AMOLED_polygon_center_obj)  },
     { MP_ROM_QSTR(MP_QSTR_colorRGB),        MP_ROM_PTR(&amoled_AMOLED_colorRGB_obj)        },
     { MP_ROM_QSTR(MP_QSTR_bitmap),          MP_ROM_PTR(&amoled_AMOLED_bitmap_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_blit),            MP_ROM_PTR(&amoled_AMOLED_blit_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_target),          MP_ROM_PTR(&amoled_AMOLED_target_obj)          },
     { MP_ROM_QSTR(MP_QSTR_jpg),             MP_ROM_PTR(&amoled_AMOLED_jpg_obj)             },
     { MP_ROM_QSTR(MP_QSTR_jpg_decode),      MP_ROM_PTR(&amoled_AMOLED_jpg_decode_obj)      },
     { MP_ROM_QSTR(MP_QSTR_text),            MP_ROM_PTR(&amoled_AMOLED_text_obj)            },
@@ -2461,10 +3759,20 @@ STATIC const mp_rom_map_elem_t amoled_AMOLED_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_rotation),        MP_ROM_PTR(&amoled_AMOLED_rotation_obj)        },
     { MP_ROM_QSTR(MP_QSTR_vscroll_area),    MP_ROM_PTR(&amoled_AMOLED_vscroll_area_obj)    },
     { MP_ROM_QSTR(MP_QSTR_vscroll_start),   MP_ROM_PTR(&amoled_AMOLED_vscroll_start_obj)   },
-    { MP_ROM_QSTR(MP_QSTR___del__),         MP_ROM_PTR(&amoled_AMOLED_deinit_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_scroll_area),     MP_ROM_PTR(&amoled_AMOLED_scroll_area_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_scroll),          MP_ROM_PTR(&amoled_AMOLED_scroll_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_record_start),    MP_ROM_PTR(&amoled_AMOLED_record_start_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_record_stop),     MP_ROM_PTR(&amoled_AMOLED_record_stop_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_replay),          MP_ROM_PTR(&amoled_AMOLED_replay_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_replay_damage),   MP_ROM_PTR(&amoled_AMOLED_replay_damage_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_dlist_info),      MP_ROM_PTR(&amoled_AMOLED_dlist_info_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_frame_buffer),    MP_ROM_PTR(&amoled_AMOLED_frame_buffer_obj)    },
+    { MP_ROM_QSTR(MP_QSTR___del__),         MP_ROM_PTR(&amoled_AMOLED_del_obj)             },
     { MP_ROM_QSTR(MP_QSTR_RGB),             MP_ROM_INT(COLOR_SPACE_RGB)                    },
     { MP_ROM_QSTR(MP_QSTR_BGR),             MP_ROM_INT(COLOR_SPACE_BGR)                    },
     { MP_ROM_QSTR(MP_QSTR_MONOCHROME),      MP_ROM_INT(COLOR_SPACE_MONOCHROME)             },
+    { MP_ROM_QSTR(MP_QSTR_DAMAGE_RECTS),    MP_ROM_INT(AMOLED_DAMAGE_RECTS)                },
+    { MP_ROM_QSTR(MP_QSTR_DAMAGE_TILES),    MP_ROM_INT(AMOLED_DAMAGE_TILES)                },
 };
 
 STATIC MP_DEFINE_CONST_DICT(amoled_AMOLED_locals_dict, amoled_AMOLED_locals_dict_table);
@@ -2490,13 +3798,432 @@ const mp_obj_type_t amoled_AMOLED_type = {
 #endif
 
 
+// Sprites : pixels drawn into the frame buffer over a copy of what they cover (save-under)
+
+// Part of the sprite inside the screen : first sprite column sx and row sy, screen position x, y and size w, h
+STATIC bool sprite_clip(amoled_sprite_obj_t *spr, int *sx, int *sy, int *x, int *y, int *w, int *h) {
+	amoled_AMOLED_obj_t *self = spr->display;
+	int x0 = (spr->x > 0) ? spr->x : 0;
+	int y0 = (spr->y > 0) ? spr->y : 0;
+	int x1 = ((spr->x + spr->w) < self->width) ? (spr->x + spr->w) : self->width;
+	int y1 = ((spr->y + spr->h) < self->height) ? (spr->y + spr->h) : self->height;
+
+	*sx = x0 - spr->x;
+	*sy = y0 - spr->y;
+	*x = x0;
+	*y = y0;
+	*w = x1 - x0;
+	*h = y1 - y0;
+	return (*w > 0) && (*h > 0);
+}
+
+// Copy the frame buffer pixels under the sprite to its save-under, or back when restore is true
+STATIC void sprite_save(amoled_sprite_obj_t *spr, bool restore) {
+	amoled_AMOLED_obj_t *self = spr->display;
+	int sx, sy, x, y, w, h;
+
+	if (!sprite_clip(spr, &sx, &sy, &x, &y, &w, &h)) {
+		return;
+	}
+	for (int row = 0; row < h; row++) {
+		uint16_t *fb = &self->frame_buffer[amoled_surface_index(&self->screen, x, y + row)];
+		uint16_t *save = &spr->save[((sy + row) * spr->w) + sx];
+		if (restore) {
+			memcpy(fb, save, 2 * w);
+		} else {
+			memcpy(save, fb, 2 * w);
+		}
+	}
+}
+
+// Draw the sprite pixels that are not masked out nor equal to its color key
+STATIC void sprite_draw(amoled_sprite_obj_t *spr) {
+	amoled_AMOLED_obj_t *self = spr->display;
+	size_t mask_stride = (spr->w + 7) / 8;
+	int sx, sy, x, y, w, h;
+
+	if (!sprite_clip(spr, &sx, &sy, &x, &y, &w, &h)) {
+		return;
+	}
+	for (int row = 0; row < h; row++) {
+		uint16_t *fb = &self->frame_buffer[amoled_surface_index(&self->screen, x, y + row)];
+		const uint16_t *src = &spr->pixels[((sy + row) * spr->w) + sx];
+		if ((spr->key < 0) && (spr->mask == NULL)) {
+			memcpy(fb, src, 2 * w);
+			continue;
+		}
+		const uint8_t *mask = (spr->mask) ? &spr->mask[(sy + row) * mask_stride] : NULL;
+		for (int col = 0; col < w; col++) {
+			int bit = sx + col;
+			if ((src[col] != spr->key) && (!mask || (mask[bit >> 3] & (0x80 >> (bit & 7))))) {
+				fb[col] = src[col];
+			}
+		}
+	}
+}
+
+// Take the sprites shown over items[i] off the frame buffer (topmost first), or draw them back in order
+// Their pixels end up unchanged outside of what items[i] changes : only its areas need to be sent
+STATIC void sprites_above(mp_obj_t *items, size_t i, size_t len, bool draw) {
+	if (draw) {
+		for (size_t j = i + 1; j < len; j++) {
+			amoled_sprite_obj_t *spr = MP_OBJ_TO_PTR(items[j]);
+			sprite_save(spr, false);
+			sprite_draw(spr);
+		}
+	} else {
+		for (size_t j = len; j > i + 1; j--) {
+			sprite_save(MP_OBJ_TO_PTR(items[j - 1]), true);
+		}
+	}
+}
+
+// Position of the sprite in the shown sprites
+STATIC size_t sprite_index(amoled_sprite_obj_t *spr, size_t *len, mp_obj_t **items) {
+	mp_obj_list_get(spr->display->sprites, len, items);
+	for (size_t i = 0; i < *len; i++) {
+		if (MP_OBJ_TO_PTR((*items)[i]) == spr) {
+			return i;
+		}
+	}
+	return *len;
+}
+
+// Damage x, y, w, h and send it at once unless auto_refresh is off or a batch is running
+STATIC void sprite_refresh(amoled_AMOLED_obj_t *self, int x, int y, int w, int h) {
+	invalidate(self, x, y, w, h);
+	if (self->auto_refresh && !self->hold_display) {
+		flush_damage(self);
+	}
+}
+
+//	Sprite(display, buffer, w, h, key=None, mask=None)
+//	buffer holds w x h pixels in the bitmap() format. Pixels equal to key, or whose mask bit is clear, are not drawn
+mp_obj_t amoled_sprite_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum {
+        ARG_display,
+        ARG_buffer,
+        ARG_w,
+        ARG_h,
+        ARG_key,
+        ARG_mask
+    };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_display, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}  },
+        { MP_QSTR_buffer,  MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}  },
+        { MP_QSTR_w,       MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}            },
+        { MP_QSTR_h,       MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}            },
+        { MP_QSTR_key,     MP_ARG_OBJ | MP_ARG_KW_ONLY,  {.u_obj = mp_const_none} },
+        { MP_QSTR_mask,    MP_ARG_OBJ | MP_ARG_KW_ONLY,  {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (!mp_obj_is_type(args[ARG_display].u_obj, &amoled_AMOLED_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("display must be an AMOLED object"));
+    }
+    amoled_AMOLED_obj_t *display = MP_OBJ_TO_PTR(args[ARG_display].u_obj);
+    if (display->pixel_bits != 16) {
+        mp_raise_ValueError(MP_ERROR_TEXT("sprites need a RGB565 frame buffer"));
+    }
+    mp_int_t w = args[ARG_w].u_int;
+    mp_int_t h = args[ARG_h].u_int;
+    if ((w <= 0) || (h <= 0) || (w > INT16_MAX) || (h > INT16_MAX)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid sprite size"));
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[ARG_buffer].u_obj, &bufinfo, MP_BUFFER_READ);
+    if ((bufinfo.len < (size_t)(2 * w * h)) || ((uintptr_t)bufinfo.buf & 1)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("sprite buffer too small or not 16 bits aligned"));
+    }
+
+    amoled_sprite_obj_t *self = m_new_obj(amoled_sprite_obj_t);
+    self->base.type = &amoled_sprite_type;
+    self->display = display;
+    self->buffer = args[ARG_buffer].u_obj;
+    self->pixels = bufinfo.buf;
+    self->w = w;
+    self->h = h;
+    self->key = (args[ARG_key].u_obj == mp_const_none) ? -1 : (mp_obj_get_int(args[ARG_key].u_obj) & 0xFFFF);
+    self->mask_obj = args[ARG_mask].u_obj;
+    self->mask = NULL;
+    if (self->mask_obj != mp_const_none) {
+        mp_get_buffer_raise(self->mask_obj, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len < (size_t)(((w + 7) / 8) * h)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("sprite mask too small"));
+        }
+        self->mask = bufinfo.buf;
+    }
+    self->x = 0;
+    self->y = 0;
+    self->shown = false;
+    self->save = m_malloc(2 * w * h);
+    AMOLED_STATS_ADD(&display->stats, allocations, 1);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+
+//	move(x, y) puts back the frame buffer under the sprite, then draws it at x, y (shows it if hidden)
+//	The old and new positions are sent as a single window
+STATIC mp_obj_t amoled_sprite_move(size_t n_args, const mp_obj_t *args) {
+	amoled_sprite_obj_t *spr = MP_OBJ_TO_PTR(args[0]);
+	amoled_AMOLED_obj_t *self = spr->display;
+	size_t len;
+	mp_obj_t *items;
+	size_t i = sprite_index(spr, &len, &items);
+	int x0 = spr->x;
+	int y0 = spr->y;
+	int x1 = spr->x + spr->w;
+	int y1 = spr->y + spr->h;
+
+	flush_sync(self);			// the sprites over this one are taken off the frame buffer for a moment
+	if (spr->shown) {
+		sprites_above(items, i, len, false);
+		sprite_save(spr, true);
+	}
+	spr->x = mp_obj_get_int(args[1]);
+	spr->y = mp_obj_get_int(args[2]);
+	sprite_save(spr, false);
+	sprite_draw(spr);
+	if (spr->shown) {
+		sprites_above(items, i, len, true);
+	} else {
+		mp_obj_list_append(self->sprites, MP_OBJ_FROM_PTR(spr));
+		spr->shown = true;
+		x0 = x1 = spr->x;
+		y0 = y1 = spr->y;
+	}
+
+	// bounding box of the old and new positions
+	x0 = (spr->x < x0) ? spr->x : x0;
+	y0 = (spr->y < y0) ? spr->y : y0;
+	x1 = (spr->x + spr->w > x1) ? spr->x + spr->w : x1;
+	y1 = (spr->y + spr->h > y1) ? spr->y + spr->h : y1;
+	sprite_refresh(self, x0, y0, x1 - x0, y1 - y0);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_sprite_move_obj, 3, 3, amoled_sprite_move);
+
+
+//	hide() puts back the frame buffer under the sprite
+STATIC mp_obj_t amoled_sprite_hide(mp_obj_t self_in) {
+	amoled_sprite_obj_t *spr = MP_OBJ_TO_PTR(self_in);
+	amoled_AMOLED_obj_t *self = spr->display;
+	size_t len;
+	mp_obj_t *items;
+	size_t i = sprite_index(spr, &len, &items);
+
+	if (!spr->shown) {
+		return mp_const_none;
+	}
+	flush_sync(self);
+	sprites_above(items, i, len, false);
+	sprite_save(spr, true);
+	spr->shown = false;
+	memmove(&items[i], &items[i + 1], (len - i - 1) * sizeof(mp_obj_t));
+	mp_obj_list_set_len(self->sprites, --len);
+	// the sprites over it moved down to index i
+	for (size_t j = i; j < len; j++) {
+		amoled_sprite_obj_t *over = MP_OBJ_TO_PTR(items[j]);
+		sprite_save(over, false);
+		sprite_draw(over);
+	}
+	sprite_refresh(self, spr->x, spr->y, spr->w, spr->h);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_sprite_hide_obj, amoled_sprite_hide);
+
+
+//	update() draws the sprite again after its buffer or mask was modified
+STATIC mp_obj_t amoled_sprite_update(mp_obj_t self_in) {
+	amoled_sprite_obj_t *spr = MP_OBJ_TO_PTR(self_in);
+	amoled_AMOLED_obj_t *self = spr->display;
+	size_t len;
+	mp_obj_t *items;
+	size_t i = sprite_index(spr, &len, &items);
+
+	if (!spr->shown) {
+		return mp_const_none;
+	}
+	flush_sync(self);
+	sprites_above(items, i, len, false);
+	sprite_save(spr, true);		// transparent pixels show what was under the sprite
+	sprite_draw(spr);
+	sprites_above(items, i, len, true);
+	sprite_refresh(self, spr->x, spr->y, spr->w, spr->h);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_sprite_update_obj, amoled_sprite_update);
+
+
+//	pos() returns the sprite position as (x, y)
+STATIC mp_obj_t amoled_sprite_pos(mp_obj_t self_in) {
+	amoled_sprite_obj_t *spr = MP_OBJ_TO_PTR(self_in);
+	mp_obj_t pos[2] = { mp_obj_new_int(spr->x), mp_obj_new_int(spr->y) };
+	return mp_obj_new_tuple(2, pos);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_sprite_pos_obj, amoled_sprite_pos);
+
+
+STATIC const mp_rom_map_elem_t amoled_sprite_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_move),    MP_ROM_PTR(&amoled_sprite_move_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_show),    MP_ROM_PTR(&amoled_sprite_move_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_hide),    MP_ROM_PTR(&amoled_sprite_hide_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_update),  MP_ROM_PTR(&amoled_sprite_update_obj)  },
+    { MP_ROM_QSTR(MP_QSTR_pos),     MP_ROM_PTR(&amoled_sprite_pos_obj)     },
+};
+
+STATIC MP_DEFINE_CONST_DICT(amoled_sprite_locals_dict, amoled_sprite_locals_dict_table);
+
+
+#ifdef MP_OBJ_TYPE_GET_SLOT
+MP_DEFINE_CONST_OBJ_TYPE(
+    amoled_sprite_type,
+    MP_QSTR_Sprite,
+    MP_TYPE_FLAG_NONE,
+    make_new, amoled_sprite_make_new,
+    locals_dict, (mp_obj_dict_t *)&amoled_sprite_locals_dict
+);
+#else
+const mp_obj_type_t amoled_sprite_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_Sprite,
+    .make_new    = amoled_sprite_make_new,
+    .locals_dict = (mp_obj_dict_t *)&amoled_sprite_locals_dict,
+};
+#endif
+
+
+// Surfaces : off-screen RGB565 render targets
+
+//	Surface(width, height, buffer=None)
+//	buffer holds width x height pixels in the bitmap() format, a cleared one is allocated when not given
+mp_obj_t amoled_surface_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum {
+        ARG_width,
+        ARG_height,
+        ARG_buffer
+    };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_width,  MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}             },
+        { MP_QSTR_height, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}             },
+        { MP_QSTR_buffer, MP_ARG_OBJ,                   {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t w = args[ARG_width].u_int;
+    mp_int_t h = args[ARG_height].u_int;
+    if ((w <= 0) || (h <= 0) || (w > INT16_MAX) || (h > INT16_MAX)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid surface size"));
+    }
+
+    amoled_surface_obj_t *self = m_new_obj(amoled_surface_obj_t);
+    self->base.type = &amoled_surface_type;
+    if (args[ARG_buffer].u_obj == mp_const_none) {
+        uint16_t *pixels = m_malloc(2 * w * h);
+        memset(pixels, 0, 2 * w * h);
+        self->buffer = mp_obj_new_bytearray_by_ref(2 * w * h, pixels);
+        amoled_surface_init(&self->surface, pixels, w, h, 16);
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[ARG_buffer].u_obj, &bufinfo, MP_BUFFER_RW);
+        if ((bufinfo.len < (size_t)(2 * w * h)) || ((uintptr_t)bufinfo.buf & 1)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("surface buffer too small or not 16 bits aligned"));
+        }
+        self->buffer = args[ARG_buffer].u_obj;
+        amoled_surface_init(&self->surface, bufinfo.buf, w, h, 16);
+    }
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+
+//	blit(surface, x, y[, key, alpha]) copies another Surface to x, y of this one
+STATIC mp_obj_t amoled_surface_blit(size_t n_args, const mp_obj_t *args) {
+	amoled_surface_t *dst = &((amoled_surface_obj_t *)MP_OBJ_TO_PTR(args[0]))->surface;
+	int32_t key;
+	uint8_t alpha;
+	amoled_surface_t *src = blit_args(n_args - 1, &args[1], &key, &alpha);
+	amoled_area_t area;
+
+	amoled_raster_blit(dst, src, mp_obj_get_int(args[2]), mp_obj_get_int(args[3]), key, alpha, &area);
+	return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_surface_blit_obj, 4, 6, amoled_surface_blit);
+
+
+STATIC mp_obj_t amoled_surface_width(mp_obj_t self_in) {
+	amoled_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	return mp_obj_new_int(self->surface.width);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_surface_width_obj, amoled_surface_width);
+
+
+STATIC mp_obj_t amoled_surface_height(mp_obj_t self_in) {
+	amoled_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	return mp_obj_new_int(self->surface.height);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_surface_height_obj, amoled_surface_height);
+
+
+//	buffer() returns the pixels, usable by bitmap(), Sprite() or layer()
+STATIC mp_obj_t amoled_surface_buffer(mp_obj_t self_in) {
+	amoled_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+	return self->buffer;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_surface_buffer_obj, amoled_surface_buffer);
+
+
+STATIC const mp_rom_map_elem_t amoled_surface_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_blit),    MP_ROM_PTR(&amoled_surface_blit_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_width),   MP_ROM_PTR(&amoled_surface_width_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_height),  MP_ROM_PTR(&amoled_surface_height_obj)  },
+    { MP_ROM_QSTR(MP_QSTR_buffer),  MP_ROM_PTR(&amoled_surface_buffer_obj)  },
+};
+
+STATIC MP_DEFINE_CONST_DICT(amoled_surface_locals_dict, amoled_surface_locals_dict_table);
+
+
+#ifdef MP_OBJ_TYPE_GET_SLOT
+MP_DEFINE_CONST_OBJ_TYPE(
+    amoled_surface_type,
+    MP_QSTR_Surface,
+    MP_TYPE_FLAG_NONE,
+    make_new, amoled_surface_make_new,
+    locals_dict, (mp_obj_dict_t *)&amoled_surface_locals_dict
+);
+#else
+const mp_obj_type_t amoled_surface_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_Surface,
+    .make_new    = amoled_surface_make_new,
+    .locals_dict = (mp_obj_dict_t *)&amoled_surface_locals_dict,
+};
+#endif
+
 STATIC const mp_map_elem_t mp_module_amoled_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),   MP_OBJ_NEW_QSTR(MP_QSTR_amoled)       },
     { MP_ROM_QSTR(MP_QSTR_AMOLED),     (mp_obj_t)&amoled_AMOLED_type         },
     { MP_ROM_QSTR(MP_QSTR_QSPIPanel),  (mp_obj_t)&amoled_qspi_bus_type       },
+    { MP_ROM_QSTR(MP_QSTR_RecordBus),  (mp_obj_t)&amoled_record_bus_type     },
+    { MP_ROM_QSTR(MP_QSTR_Sprite),     (mp_obj_t)&amoled_sprite_type         },
+    { MP_ROM_QSTR(MP_QSTR_Surface),    (mp_obj_t)&amoled_surface_type        },
     { MP_ROM_QSTR(MP_QSTR_RGB),        MP_ROM_INT(COLOR_SPACE_RGB)           },
     { MP_ROM_QSTR(MP_QSTR_BGR),        MP_ROM_INT(COLOR_SPACE_BGR)           },
     { MP_ROM_QSTR(MP_QSTR_MONOCHROME), MP_ROM_INT(COLOR_SPACE_MONOCHROME)    },
+    { MP_ROM_QSTR(MP_QSTR_DAMAGE_RECTS), MP_ROM_INT(AMOLED_DAMAGE_RECTS)     },
+    { MP_ROM_QSTR(MP_QSTR_DAMAGE_TILES), MP_ROM_INT(AMOLED_DAMAGE_TILES)     },
     { MP_ROM_QSTR(MP_QSTR_BLACK),      MP_ROM_INT(BLACK)                     },
     { MP_ROM_QSTR(MP_QSTR_BLUE),       MP_ROM_INT(BLUE)                      },
     { MP_ROM_QSTR(MP_QSTR_RED),        MP_ROM_INT(RED)                       },
@@ -9,6 +9,11 @@ extern "C" {
 #include "mpfile/mpfile.h"
 
 #include "amoled_qspi_bus.h"
+#include "amoled_damage.h"
+#include "amoled_dlist.h"
+#include "amoled_worker.h"
+#include "amoled_blit.h"
+#include "amoled_raster.h"
 
 #define LCD_CMD_NOP          0x00 // This command is empty command
 #define LCD_CMD_SWRESET      0x01 // Software reset registers (the built-in frame buffer is not affected)
@@ -99,7 +104,8 @@ extern "C" {
 #define RM690B0_MADCTL_MH 0x04
 #define RM690B0_MADCTL_RGB 0x00
 
-//SH8601 MADCTRL and RGB (SH8601 does not support rotations)
+//SH8601 MADCTRL and RGB (SH8601 has no row/column exchange, 90 and 270 degrees are done by the driver)
+#define SH8601_MADCTL_SW_MV 0x20 // Not sent : the driver transposes the frame buffer when refreshing
 #define SH8601_MADCTL_BGR 0x08
 #define SH8601_MADCTL_X_FLIP 0x02 // Flip Horizontal
 #define SH8601_MADCTL_Y_FLIP 0x05 // Flip Vertical
@@ -120,10 +126,10 @@ extern "C" {
 #define COLOR_SPACE_BGR        (1)
 #define COLOR_SPACE_MONOCHROME (2)
 
-typedef struct _Point {
-    mp_float_t x;
-    mp_float_t y;
-} Point;
+#define AMOLED_STAGING_BUFFERS  2       // Staging buffers in the pool
+#define AMOLED_STAGING_SIZE     16384   // Default size of each staging buffer in bytes
+
+typedef amoled_point_t Point;   // same layout the rendering core fills polygons from
 
 typedef struct _Polygon {
     int length;
@@ -138,11 +144,27 @@ typedef struct _amoled_rotation_t {
     uint16_t rowstart;
 } amoled_rotation_t;
 
+#define AMOLED_LAYERS 4     // off-screen layers composited over the frame buffer, layer n is drawn over n - 1
+
+// A layer is a RGB565 pixel buffer (same byte order as the frame buffer) placed in frame buffer coordinates
+typedef struct _amoled_layer_t {
+    mp_obj_t buffer;            // keeps the pixels alive, MP_OBJ_NULL when the layer is not attached
+    const uint16_t *pixels;
+    int16_t x;
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+    int32_t key;                // transparent color, -1 for none
+    uint8_t alpha;              // 0 (transparent) to 255 (opaque)
+    bool visible;
+} amoled_layer_t;
+
 typedef struct _amoled_AMOLED_obj_t {
     mp_obj_base_t base;
     mp_obj_base_t *bus_obj;
     amoled_panel_p_t *lcd_panel_p;
     mp_obj_t reset;
+    mp_obj_t te;                // tearing effect input pin or MP_OBJ_NULL
 	mp_file_t *fp;              //File object
 	uint16_t *pixel_buffer;		// resident buffer if buffer_size given
     bool reset_level;
@@ -167,24 +189,92 @@ typedef struct _amoled_AMOLED_obj_t {
     int y_gap;
 	uint8_t type;
     uint32_t bpp;
-    uint8_t fb_bpp;
+    uint8_t fb_bpp;             // panel pixel format : 16, 18 or 24 bits
+    uint8_t bus_pixel_bytes;    // bytes sent for each pixel : 2 in RGB565, 3 in RGB666 and RGB888
+    amoled_blit_expand_t expand;    // RGB565 to RGB666 / RGB888 tables used by the flush
     uint8_t madctl_val; // save current value of LCD_CMD_MADCTL register
+    bool transpose;     // frame buffer columns are sent as panel rows (SH8601_MADCTL_SW_MV rotations)
     uint8_t colmod_cal; // save surrent value of LCD_CMD_COLMOD register
 
 	//Frame Buffer related
     bool auto_refresh;
-	bool hold_display;
+	uint16_t hold_display;      // batch depth : nothing is sent while it is not 0
 	// frame_buffer is the whole display frame buffer
     size_t frame_buffer_size;
     uint16_t *frame_buffer;
-	// partial_frame_buffer is a temporary frame buffer
-	size_t partial_frame_buffer_size;
-	uint16_t *partial_frame_buffer;  
+	uint16_t *front;            // frame sent to the display : frame_buffer itself unless double buffered
+	bool double_buffer;         // primitives draw in frame_buffer while front is sent, swapped by each refresh
+	uint8_t pixel_bits;         // frame buffer bits per pixel : 16 (RGB565) or 8 / 4 (palette indexes)
+	uint16_t lut[256];          // palette : RGB565 value sent for each index of an indexed frame buffer
+	// staging buffers gather non contiguous windows before sending them (DMA capable when possible)
+	size_t staging_size;
+	uint16_t *staging[AMOLED_STAGING_BUFFERS];
+	uint8_t staging_idx;        // next staging buffer to use
+	uint8_t staging_gc;         // bit i is set when staging[i] comes from the Micropython heap
+	bool fb_dma_capable;        // frame_buffer can be sent by DMA without bounce buffer
+	bool async_refresh;         // refresh only queues the transfers, wait() fences them
+	uint32_t staging_fence[AMOLED_STAGING_BUFFERS];   // bus fence of the last transfer from staging[i]
+	amoled_worker_t *worker;    // flush worker on the other core, NULL when refresh sends from the caller
+
+#if AMOLED_STATS
+	amoled_stats_t stats;       // transfer statistics, see stats()
+#endif
+
+	// Tearing effect (TE) signal, updated by the TE pin interrupt
+	int te_pin;
+	volatile uint32_t te_count;         // TE rising edges seen
+	volatile int64_t te_last_us;        // time of the last TE edge
+	volatile uint32_t te_period_us;     // averaged time between two TE edges (panel refresh period)
+	// damage holds the frame buffer areas not yet sent to the display
+	amoled_damage_t damage;
+	// screen describes the frame buffer as a render target, its clip is the whole screen unless a display list is replayed
+	// It also holds the ring addressing of the scroll region (scroll_area)
+	amoled_surface_t screen;
+	bool scroll_pending;        // the scroll start register is written with the uncovered rows, on the next flush
+	amoled_surface_t *target;   // where the primitives draw : &screen, or the Surface selected by target()
+	mp_obj_t target_obj;        // keeps the selected Surface alive, MP_OBJ_NULL for the screen
+	// dlist records the drawing calls, dlist_objs holds their arguments that are not small integers
+	amoled_dlist_t dlist;
+	mp_obj_t dlist_objs;
+	// shadow is a copy of the frame last sent, refresh only sends the spans that differ from it
+	uint16_t *shadow;
+	bool shadow_valid;          // shadow matches the display memory
+	// layers are composited over the frame buffer while the damaged areas are staged, never into it
+	amoled_layer_t layers[AMOLED_LAYERS];
+	uint16_t *layer_row;        // RGB565 row composited aside (deep color or transposed staging)
+	// sprites shown in the frame buffer, in drawing order : each one covers the save-under of the next ones
+	mp_obj_t sprites;
 	
 } amoled_AMOLED_obj_t;
 
+// A sprite is drawn into the frame buffer, the pixels it covers are kept in save to be put back
+typedef struct _amoled_sprite_obj_t {
+    mp_obj_base_t base;
+    amoled_AMOLED_obj_t *display;
+    mp_obj_t buffer;            // RGB565 pixels, same format as bitmap()
+    const uint16_t *pixels;
+    mp_obj_t mask_obj;          // optional mask : 1 bit per pixel, rows of (w + 7) / 8 bytes, MSB first
+    const uint8_t *mask;
+    uint16_t w;
+    uint16_t h;
+    int32_t key;                // transparent color, -1 for none
+    int16_t x;                  // logical position
+    int16_t y;
+    bool shown;
+    uint16_t *save;             // frame buffer pixels under the sprite while it is shown
+} amoled_sprite_obj_t;
+
+// An off-screen RGB565 render target, drawn into with AMOLED.target() and blitted with blit()
+typedef struct _amoled_surface_obj_t {
+    mp_obj_base_t base;
+    mp_obj_t buffer;            // pixels : the buffer given to the constructor or an allocated bytearray
+    amoled_surface_t surface;
+} amoled_surface_obj_t;
+
 mp_obj_t amoled_AMOLED_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args);
 extern const mp_obj_type_t amoled_AMOLED_type;
+extern const mp_obj_type_t amoled_sprite_type;
+extern const mp_obj_type_t amoled_surface_type;
 
 #ifdef  __cplusplus
 }
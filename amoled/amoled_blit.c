@@ -0,0 +1,282 @@
+/* Pixel kernels for the AMOLED driver
+
+Plain C, no Micropython dependency.
+*/
+
+#include <string.h>
+
+#include "amoled_blit.h"
+
+// 32 bits access to 16 bits pixels, without breaking the aliasing rules
+typedef uint32_t __attribute__((__may_alias__)) amoled_blit_word_t;
+
+#if AMOLED_BLIT_PIE
+// n 16 bytes words of color from the 16 bytes aligned dst, n > 0 : EE.VLDBC.16 broadcasts the
+// color to the 8 lanes of q0, EE.VST.128.IP stores them and steps dst. q0 is not allocated by the compiler
+static uint16_t *fill16_pie(uint16_t *dst, uint16_t color, size_t n) {
+    __asm__ volatile (
+        "ee.vldbc.16 q0, %2\n"
+        "1:\n"
+        "ee.vst.128.ip q0, %0, 16\n"
+        "addi %1, %1, -1\n"
+        "bnez %1, 1b\n"
+        : "+r" (dst), "+r" (n)
+        : "r" (&color)
+        : "memory");
+    return dst;
+}
+#endif
+
+void amoled_blit_fill16(uint16_t *dst, uint16_t color, size_t n) {
+    uint32_t pair = ((uint32_t)color << 16) | color;
+    amoled_blit_word_t *w;
+
+    if (n && ((uintptr_t)dst & 2)) {
+        *dst++ = color;
+        n--;
+    }
+    w = (amoled_blit_word_t *)dst;
+#if AMOLED_BLIT_PIE
+    if (n >= 16) {
+        while ((uintptr_t)w & 15) {
+            *w++ = pair;
+            n -= 2;
+        }
+        w = (amoled_blit_word_t *)fill16_pie((uint16_t *)w, color, n >> 3);
+        n &= 7;
+    }
+#endif
+    // 8 pixels per step : Xtensa does not vectorize, the unrolled stores keep its pipeline busy
+    while (n >= 8) {
+        w[0] = pair;
+        w[1] = pair;
+        w[2] = pair;
+        w[3] = pair;
+        w += 4;
+        n -= 8;
+    }
+    while (n >= 2) {
+        *w++ = pair;
+        n -= 2;
+    }
+    if (n) {
+        *(uint16_t *)w = color;
+    }
+}
+
+// dst[c * dst_stride + r] = src[r * src_stride + c] for r < rows and c < cols
+// Walking the source by blocks keeps both the read rows and the written rows in cache,
+// a plain column walk would miss on every source pixel of a large frame buffer
+void amoled_blit_transpose16(uint16_t *dst, size_t dst_stride, const uint16_t *src, size_t src_stride,
+                             uint16_t cols, uint16_t rows) {
+    for (uint16_t r0 = 0; r0 < rows; r0 += AMOLED_BLIT_BLOCK) {
+        uint16_t r1 = (rows - r0 < AMOLED_BLIT_BLOCK) ? rows : r0 + AMOLED_BLIT_BLOCK;
+        for (uint16_t c0 = 0; c0 < cols; c0 += AMOLED_BLIT_BLOCK) {
+            uint16_t c1 = (cols - c0 < AMOLED_BLIT_BLOCK) ? cols : c0 + AMOLED_BLIT_BLOCK;
+            for (uint16_t c = c0; c < c1; c++) {
+                uint16_t *d = &dst[c * dst_stride + r0];
+                const uint16_t *s = &src[r0 * src_stride + c];
+                for (uint16_t r = r0; r < r1; r++) {
+                    *d++ = *s;
+                    s += src_stride;
+                }
+            }
+        }
+    }
+}
+
+void amoled_blit_lut8(uint16_t *dst, const uint8_t *src, const uint16_t *lut, size_t n) {
+    // 4 pixels per step, the table stays in cache (512 bytes)
+    while (n >= 4) {
+        dst[0] = lut[src[0]];
+        dst[1] = lut[src[1]];
+        dst[2] = lut[src[2]];
+        dst[3] = lut[src[3]];
+        dst += 4;
+        src += 4;
+        n -= 4;
+    }
+    while (n--) {
+        *dst++ = lut[*src++];
+    }
+}
+
+void amoled_blit_lut4(uint16_t *dst, const uint8_t *src, const uint16_t *lut, size_t n) {
+    for (size_t i = 0; i < n / 2; i++) {
+        uint8_t b = src[i];
+        *dst++ = lut[b >> 4];
+        *dst++ = lut[b & 0x0F];
+    }
+    if (n & 1) {
+        *dst = lut[src[n / 2] >> 4];
+    }
+}
+
+// Same walk as amoled_blit_transpose16, expanding the indexes on the way
+void amoled_blit_transpose_lut8(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                const uint16_t *lut, uint16_t cols, uint16_t rows) {
+    for (uint16_t r0 = 0; r0 < rows; r0 += AMOLED_BLIT_BLOCK) {
+        uint16_t r1 = (rows - r0 < AMOLED_BLIT_BLOCK) ? rows : r0 + AMOLED_BLIT_BLOCK;
+        for (uint16_t c0 = 0; c0 < cols; c0 += AMOLED_BLIT_BLOCK) {
+            uint16_t c1 = (cols - c0 < AMOLED_BLIT_BLOCK) ? cols : c0 + AMOLED_BLIT_BLOCK;
+            for (uint16_t c = c0; c < c1; c++) {
+                uint16_t *d = &dst[c * dst_stride + r0];
+                const uint8_t *s = &src[r0 * src_stride + c];
+                for (uint16_t r = r0; r < r1; r++) {
+                    *d++ = lut[*s];
+                    s += src_stride;
+                }
+            }
+        }
+    }
+}
+
+// Columns x to x + cols - 1 of the 4 bits rows at src
+void amoled_blit_transpose_lut4(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                uint16_t x, const uint16_t *lut, uint16_t cols, uint16_t rows) {
+    for (uint16_t r0 = 0; r0 < rows; r0 += AMOLED_BLIT_BLOCK) {
+        uint16_t r1 = (rows - r0 < AMOLED_BLIT_BLOCK) ? rows : r0 + AMOLED_BLIT_BLOCK;
+        for (uint16_t c0 = 0; c0 < cols; c0 += AMOLED_BLIT_BLOCK) {
+            uint16_t c1 = (cols - c0 < AMOLED_BLIT_BLOCK) ? cols : c0 + AMOLED_BLIT_BLOCK;
+            for (uint16_t c = c0; c < c1; c++) {
+                uint16_t *d = &dst[c * dst_stride + r0];
+                const uint8_t *s = &src[r0 * src_stride + ((x + c) >> 1)];
+                uint8_t shift = ((x + c) & 1) ? 0 : 4;
+                for (uint16_t r = r0; r < r1; r++) {
+                    *d++ = lut[(*s >> shift) & 0x0F];
+                    s += src_stride;
+                }
+            }
+        }
+    }
+}
+
+// Replicating the high bits fills the low ones : 0x1F expands to 0xFF, not 0xF8
+void amoled_blit_expand_init(amoled_blit_expand_t *t, uint8_t bpp) {
+    for (uint8_t i = 0; i < 32; i++) {
+        t->r[i] = (bpp == 18) ? (((i << 1) | (i >> 4)) << 2) : ((i << 3) | (i >> 2));
+        t->b[i] = t->r[i];
+    }
+    for (uint8_t i = 0; i < 64; i++) {
+        t->g[i] = (bpp == 18) ? (i << 2) : ((i << 2) | (i >> 4));
+    }
+}
+
+// The frame buffer keeps RRRRRGGG GGGBBBBB in memory order : read as a little endian word the
+// first byte is the low one. Three small tables replace the shifts and masks of each channel.
+void amoled_blit_expand24(uint8_t *dst, const uint16_t *src, const amoled_blit_expand_t *t, size_t n) {
+    while (n--) {
+        uint16_t v = *src++;
+        uint8_t hi = v & 0xFF;
+        uint8_t lo = v >> 8;
+        dst[0] = t->r[hi >> 3];
+        dst[1] = t->g[((hi & 0x07) << 3) | (lo >> 5)];
+        dst[2] = t->b[lo & 0x1F];
+        dst += 3;
+    }
+}
+
+void amoled_blit_transpose_expand24(uint8_t *dst, size_t dst_stride, const uint16_t *src, size_t src_stride,
+                                    const amoled_blit_expand_t *t, uint16_t cols, uint16_t rows) {
+    for (uint16_t r0 = 0; r0 < rows; r0 += AMOLED_BLIT_BLOCK) {
+        uint16_t r1 = (rows - r0 < AMOLED_BLIT_BLOCK) ? rows : r0 + AMOLED_BLIT_BLOCK;
+        for (uint16_t c0 = 0; c0 < cols; c0 += AMOLED_BLIT_BLOCK) {
+            uint16_t c1 = (cols - c0 < AMOLED_BLIT_BLOCK) ? cols : c0 + AMOLED_BLIT_BLOCK;
+            for (uint16_t c = c0; c < c1; c++) {
+                uint8_t *d = &dst[3 * (c * dst_stride + r0)];
+                const uint16_t *s = &src[r0 * src_stride + c];
+                for (uint16_t r = r0; r < r1; r++) {
+                    amoled_blit_expand24(d, s, t, 1);
+                    d += 3;
+                    s += src_stride;
+                }
+            }
+        }
+    }
+}
+
+void amoled_blit_lut1(uint16_t *dst, const uint8_t *src, size_t x, const uint16_t *lut, size_t n) {
+    uint16_t c0 = lut[0], c1 = lut[1];
+
+    src += x >> 3;
+    uint8_t mask = 0x80 >> (x & 7);
+    // head up to a byte boundary, then whole bytes
+    while ((mask != 0x80) && n) {
+        *dst++ = (*src & mask) ? c1 : c0;
+        mask >>= 1;
+        n--;
+        if (mask == 0) {
+            mask = 0x80;
+            src++;
+        }
+    }
+    while (n >= 8) {
+        uint8_t b = *src++;
+        for (uint8_t m = 0x80; m; m >>= 1) {
+            *dst++ = (b & m) ? c1 : c0;
+        }
+        n -= 8;
+    }
+    for (; n; n--, mask >>= 1) {
+        *dst++ = (*src & mask) ? c1 : c0;
+    }
+}
+
+void amoled_blit_transpose_lut1(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                size_t x, const uint16_t *lut, uint16_t cols, uint16_t rows) {
+    for (uint16_t r0 = 0; r0 < rows; r0 += AMOLED_BLIT_BLOCK) {
+        uint16_t r1 = (rows - r0 < AMOLED_BLIT_BLOCK) ? rows : r0 + AMOLED_BLIT_BLOCK;
+        for (uint16_t c0 = 0; c0 < cols; c0 += AMOLED_BLIT_BLOCK) {
+            uint16_t c1 = (cols - c0 < AMOLED_BLIT_BLOCK) ? cols : c0 + AMOLED_BLIT_BLOCK;
+            for (uint16_t c = c0; c < c1; c++) {
+                uint16_t *d = &dst[c * dst_stride + r0];
+                size_t bit = r0 * src_stride + x + c;
+                for (uint16_t r = r0; r < r1; r++) {
+                    *d++ = lut[(src[bit >> 3] >> (7 - (bit & 7))) & 1];
+                    bit += src_stride;
+                }
+            }
+        }
+    }
+}
+
+// Blend two RGB565 pixels packed in a word (as sent : bytes swapped in each half) with a 0..32 weight for s
+// The fields are split in two groups with 5 free bits above each one, so both pixels are blended at once :
+// B0 R0 G1 in place, and G0 B1 R1 shifted down by 5
+static inline uint32_t blend2(uint32_t s, uint32_t d, uint32_t a) {
+    s = ((s & 0x00FF00FF) << 8) | ((s >> 8) & 0x00FF00FF);
+    d = ((d & 0x00FF00FF) << 8) | ((d >> 8) & 0x00FF00FF);
+    uint32_t lo = (((s & 0x07E0F81F) * a + (d & 0x07E0F81F) * (32 - a)) >> 5) & 0x07E0F81F;
+    uint32_t hi = ((((s >> 5) & 0x07C0F83F) * a + ((d >> 5) & 0x07C0F83F) * (32 - a)) >> 5) & 0x07C0F83F;
+    uint32_t p = lo | (hi << 5);
+    return ((p & 0x00FF00FF) << 8) | ((p >> 8) & 0x00FF00FF);
+}
+
+// Two pixels per word : the words are read with memcpy as the rows are only 16 bits aligned
+// (little endian, pixel i is the low half of the word)
+void amoled_blit_compose(uint16_t *dst, const uint16_t *src, size_t n, int32_t key, uint8_t alpha) {
+    uint32_t a = (alpha + 4) >> 3;
+    size_t i = 0;
+
+    if (a == 0) {
+        return;
+    }
+    if ((a == 32) && (key < 0)) {
+        memcpy(dst, src, 2 * n);
+        return;
+    }
+    for (; i + 1 < n; i += 2) {
+        uint32_t s, d;
+        memcpy(&s, &src[i], 4);
+        memcpy(&d, &dst[i], 4);
+        uint32_t p = (a == 32) ? s : blend2(s, d, a);
+        if (key >= 0) {
+            uint32_t keep = ((src[i] == key) ? 0x0000FFFF : 0) | ((src[i + 1] == key) ? 0xFFFF0000 : 0);
+            p = (p & ~keep) | (d & keep);
+        }
+        memcpy(&dst[i], &p, 4);
+    }
+    if ((i < n) && (src[i] != key)) {
+        dst[i] = (a == 32) ? src[i] : (uint16_t)blend2(src[i], dst[i], a);
+    }
+}
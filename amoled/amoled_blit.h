@@ -0,0 +1,65 @@
+#ifndef __AMOLED_BLIT_H__
+#define __AMOLED_BLIT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Pixel kernels used by the flush path to build the staging buffers.
+
+Plain C, no Micropython dependency. Strides are in pixels, except the source stride of the
+indexed kernels which is in bytes (in bits for 1 bit pixels). 4 bits rows start on a byte (EVEN column),
+1 bit pixels are packed most significant bit first from bit x of src.
+*/
+
+#define AMOLED_BLIT_BLOCK 16    // transpose block side : 16 pixels rows are one 32 bytes cache line
+
+// ESP32-S3 vector unit (PIE) : the span fill stores 128 bits words, set by micropython.cmake on that target
+#ifndef AMOLED_BLIT_PIE
+#define AMOLED_BLIT_PIE 0
+#endif
+
+// RGB565 to 3 bytes per pixel tables : RGB888 (COLMOD 0x77) or RGB666 in the 6 high bits (COLMOD 0x66)
+typedef struct _amoled_blit_expand_t {
+    uint8_t r[32];
+    uint8_t g[64];
+    uint8_t b[32];
+} amoled_blit_expand_t;
+
+// Fill n RGB565 pixels with color : a 16 bits head to the first word boundary, 32 bits words
+// (128 bits with AMOLED_BLIT_PIE) and a 16 bits tail. dst needs only the 2 bytes alignment of its pixels
+void amoled_blit_fill16(uint16_t *dst, uint16_t color, size_t n);
+
+void amoled_blit_transpose16(uint16_t *dst, size_t dst_stride, const uint16_t *src, size_t src_stride,
+                             uint16_t cols, uint16_t rows);
+
+// Palette expansion : indexed pixels to the RGB565 values of lut (4 bits pixels : high nibble first)
+void amoled_blit_lut8(uint16_t *dst, const uint8_t *src, const uint16_t *lut, size_t n);
+void amoled_blit_lut4(uint16_t *dst, const uint8_t *src, const uint16_t *lut, size_t n);
+void amoled_blit_transpose_lut8(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                const uint16_t *lut, uint16_t cols, uint16_t rows);
+void amoled_blit_transpose_lut4(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                uint16_t x, const uint16_t *lut, uint16_t cols, uint16_t rows);
+void amoled_blit_lut1(uint16_t *dst, const uint8_t *src, size_t x, const uint16_t *lut, size_t n);
+void amoled_blit_transpose_lut1(uint16_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                size_t x, const uint16_t *lut, uint16_t cols, uint16_t rows);
+
+// Deep color expansion of RGB565 pixels stored as sent (high byte first), 3 bytes per pixel out
+void amoled_blit_expand_init(amoled_blit_expand_t *t, uint8_t bpp);
+void amoled_blit_expand24(uint8_t *dst, const uint16_t *src, const amoled_blit_expand_t *t, size_t n);
+void amoled_blit_transpose_expand24(uint8_t *dst, size_t dst_stride, const uint16_t *src, size_t src_stride,
+                                    const amoled_blit_expand_t *t, uint16_t cols, uint16_t rows);
+
+// Layer composition of RGB565 pixels stored as sent over dst : pixels equal to key (-1 for none) are
+// transparent, the others are blended with alpha (0 transparent to 255 opaque, 5 bits precision)
+void amoled_blit_compose(uint16_t *dst, const uint16_t *src, size_t n, int32_t key, uint8_t alpha);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
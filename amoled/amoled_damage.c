@@ -0,0 +1,278 @@
+/* Damage tracker for the AMOLED frame buffer
+
+Plain C, no Micropython dependency : amoled.c records every frame buffer write here
+and flushes the resulting windows on refresh.
+*/
+
+#include "amoled_damage.h"
+
+#include <string.h>
+
+void amoled_damage_init(amoled_damage_t *d) {
+    memset(d, 0, sizeof(amoled_damage_t));
+    d->overhead = AMOLED_WINDOW_OVERHEAD_PX;
+}
+
+void amoled_damage_clear(amoled_damage_t *d) {
+    d->count = 0;
+    memset(d->tiles, 0, sizeof(d->tiles));
+}
+
+// Select the rectangle list or the tile bitmap, pending damage is dropped
+// Returns false if the screen is too large for the tile bitmap
+bool amoled_damage_set_mode(amoled_damage_t *d, uint8_t mode, uint16_t width, uint16_t height) {
+    if ((mode == AMOLED_DAMAGE_TILES) &&
+        ((width > (AMOLED_TILE_COLS_MAX << AMOLED_TILE_SHIFT)) || (height > (AMOLED_TILE_ROWS_MAX << AMOLED_TILE_SHIFT)))) {
+        return false;
+    }
+    if (mode > AMOLED_DAMAGE_TILES) {
+        return false;
+    }
+    amoled_damage_clear(d);
+    d->mode = mode;
+    return true;
+}
+
+// Pending areas in rectangle mode, dirty tiles in tile mode
+uint32_t amoled_damage_pending(const amoled_damage_t *d) {
+    if (d->mode != AMOLED_DAMAGE_TILES) {
+        return d->count;
+    }
+    uint32_t n = 0;
+    for (int r = 0; r < AMOLED_TILE_ROWS_MAX; r++) {
+        n += __builtin_popcountll(d->tiles[r]);
+    }
+    return n;
+}
+
+void amoled_damage_reset_stats(amoled_damage_t *d) {
+    d->invalidations = 0;
+    d->merges = 0;
+    d->flushes = 0;
+    d->windows = 0;
+    d->bytes_naive = 0;
+    d->bytes_sent = 0;
+    d->bytes_compared = 0;
+    d->diff_us = 0;
+}
+
+// Clip x, y, w, h to the screen and align it to the panel rule (SC/SR EVEN, EC/ER ODD)
+// Returns false if nothing is left after clipping
+bool amoled_damage_align(amoled_area_t *a, int x, int y, int w, int h, uint16_t width, uint16_t height) {
+    int x1 = x + w - 1;
+    int y1 = y + h - 1;
+
+    if ((w <= 0) | (h <= 0) | (x1 < 0) | (y1 < 0) | (x >= width) | (y >= height)) {
+        return false;
+    }
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 >= width) {
+        x1 = width - 1;
+    }
+    if (y1 >= height) {
+        y1 = height - 1;
+    }
+    a->x0 = x & 0xFFFE;
+    a->y0 = y & 0xFFFE;
+    a->x1 = x1 | 0x0001;
+    a->y1 = y1 | 0x0001;
+    // Odd panel sizes can not hold the last column / row pair
+    if (a->x1 >= width) {
+        a->x1 = width - 1;
+    }
+    if (a->y1 >= height) {
+        a->y1 = height - 1;
+    }
+    return true;
+}
+
+static inline void area_union(amoled_area_t *u, const amoled_area_t *a, const amoled_area_t *b) {
+    u->x0 = (a->x0 < b->x0) ? a->x0 : b->x0;
+    u->y0 = (a->y0 < b->y0) ? a->y0 : b->y0;
+    u->x1 = (a->x1 > b->x1) ? a->x1 : b->x1;
+    u->y1 = (a->y1 > b->y1) ? a->y1 : b->y1;
+}
+
+// Overlapping or touching areas
+static inline bool area_touch(const amoled_area_t *a, const amoled_area_t *b) {
+    return (a->x0 <= b->x1 + 1) && (b->x0 <= a->x1 + 1) && (a->y0 <= b->y1 + 1) && (b->y0 <= a->y1 + 1);
+}
+
+static inline uint32_t area_intersection(const amoled_area_t *a, const amoled_area_t *b) {
+    int x0 = (a->x0 > b->x0) ? a->x0 : b->x0;
+    int y0 = (a->y0 > b->y0) ? a->y0 : b->y0;
+    int x1 = (a->x1 < b->x1) ? a->x1 : b->x1;
+    int y1 = (a->y1 < b->y1) ? a->y1 : b->y1;
+    if ((x1 < x0) | (y1 < y0)) {
+        return 0;
+    }
+    return (uint32_t)(x1 - x0 + 1) * (uint32_t)(y1 - y0 + 1);
+}
+
+// Merge b into a if the union does not send more than one window overhead of useless pixels
+static bool area_try_merge(const amoled_damage_t *d, amoled_area_t *a, const amoled_area_t *b) {
+    amoled_area_t u;
+
+    if (!area_touch(a, b)) {
+        return false;
+    }
+    area_union(&u, a, b);
+    uint32_t useful = amoled_area_pixels(a) + amoled_area_pixels(b) - area_intersection(a, b);
+    if (amoled_area_pixels(&u) > useful + d->overhead) {
+        return false;
+    }
+    *a = u;
+    return true;
+}
+
+// Bit mask of tile columns c0 to c1
+static inline uint64_t tile_span(int c0, int c1) {
+    return ((c1 - c0 == 63) ? UINT64_MAX : ((1ULL << (c1 - c0 + 1)) - 1)) << c0;
+}
+
+// Mark the tiles covered by an aligned area
+static void tiles_add(amoled_damage_t *d, const amoled_area_t *r) {
+    int c0 = r->x0 >> AMOLED_TILE_SHIFT;
+    int c1 = r->x1 >> AMOLED_TILE_SHIFT;
+    uint64_t mask = tile_span(c0, c1);
+
+    for (int row = r->y0 >> AMOLED_TILE_SHIFT; row <= (r->y1 >> AMOLED_TILE_SHIFT); row++) {
+        d->tiles[row] |= mask;
+    }
+}
+
+void amoled_damage_add(amoled_damage_t *d, int x, int y, int w, int h, uint16_t width, uint16_t height) {
+    amoled_area_t r;
+    amoled_area_t u;
+
+    if (!amoled_damage_align(&r, x, y, w, h, width, height)) {
+        return;
+    }
+    d->invalidations++;
+
+    if (d->mode == AMOLED_DAMAGE_TILES) {
+        tiles_add(d, &r);
+        return;
+    }
+
+    for (;;) {
+        // Absorb every pending area that is worth merging, the grown area may catch new ones
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (uint8_t i = 0; i < d->count; i++) {
+                if (area_try_merge(d, &r, &d->rects[i])) {
+                    d->rects[i] = d->rects[--d->count];
+                    d->merges++;
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        if (d->count < AMOLED_DAMAGE_MAX_RECTS) {
+            break;
+        }
+        // List is full : force the merge that adds the fewest pixels
+        uint8_t best = 0;
+        uint32_t best_growth = UINT32_MAX;
+        for (uint8_t i = 0; i < d->count; i++) {
+            area_union(&u, &r, &d->rects[i]);
+            uint32_t growth = amoled_area_pixels(&u) - amoled_area_pixels(&d->rects[i]);
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        area_union(&r, &r, &d->rects[best]);
+        d->rects[best] = d->rects[--d->count];
+        d->merges++;
+    }
+    d->rects[d->count++] = r;
+}
+
+// Plan the next window of the tile bitmap
+// The window starts on the first dirty tile, grows right over clean gaps and then down over
+// tile rows while the clean tiles it would send cost less than opening another window.
+static bool tiles_next(amoled_damage_t *d, amoled_area_t *a, uint16_t width, uint16_t height) {
+    const uint32_t tile_px = AMOLED_TILE_SIZE * AMOLED_TILE_SIZE;
+    int rows = (height + AMOLED_TILE_SIZE - 1) >> AMOLED_TILE_SHIFT;
+    int r0 = 0;
+
+    while ((r0 < rows) && (d->tiles[r0] == 0)) {
+        r0++;
+    }
+    if (r0 == rows) {
+        return false;
+    }
+
+    // Horizontal run : bridge a clean gap if it is cheaper than a new window
+    uint64_t bits = d->tiles[r0];
+    int c0 = __builtin_ctzll(bits);
+    int c1 = c0;
+    for (;;) {
+        while ((c1 < 63) && (bits & (1ULL << (c1 + 1)))) {
+            c1++;
+        }
+        uint64_t rest = (c1 < 63) ? (bits >> (c1 + 1)) : 0;
+        if (rest == 0) {
+            break;
+        }
+        int gap = __builtin_ctzll(rest);
+        if ((uint32_t)gap * tile_px > d->overhead) {
+            break;
+        }
+        c1 += gap + 1;
+    }
+    uint64_t span = tile_span(c0, c1);
+    uint32_t clean = __builtin_popcountll(span & ~bits);
+
+    // Vertical growth : the next tile row joins if it has dirty tiles in the span and
+    // its clean ones are worth less than a window
+    int r1 = r0;
+    while (r1 + 1 < rows) {
+        uint64_t next = d->tiles[r1 + 1] & span;
+        if (next == 0) {
+            break;
+        }
+        uint32_t next_clean = __builtin_popcountll(span & ~next);
+        if (next_clean * tile_px > d->overhead) {
+            break;
+        }
+        clean += next_clean;
+        r1++;
+    }
+
+    for (int r = r0; r <= r1; r++) {
+        d->tiles[r] &= ~span;
+    }
+    d->merges += clean;
+
+    a->x0 = c0 << AMOLED_TILE_SHIFT;
+    a->y0 = r0 << AMOLED_TILE_SHIFT;
+    a->x1 = ((c1 + 1) << AMOLED_TILE_SHIFT) - 1;
+    a->y1 = ((r1 + 1) << AMOLED_TILE_SHIFT) - 1;
+    if (a->x1 >= width) {
+        a->x1 = width - 1;
+    }
+    if (a->y1 >= height) {
+        a->y1 = height - 1;
+    }
+    return true;
+}
+
+// Pop the next window to send, returns false when nothing is left
+bool amoled_damage_next(amoled_damage_t *d, amoled_area_t *a, uint16_t width, uint16_t height) {
+    if (d->mode == AMOLED_DAMAGE_TILES) {
+        return tiles_next(d, a, width, height);
+    }
+    if (d->count == 0) {
+        return false;
+    }
+    *a = d->rects[--d->count];
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef __AMOLED_DAMAGE_H__
+#define __AMOLED_DAMAGE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+Damage tracker : records the frame buffer areas written since the last flush.
+
+Areas are stored already aligned to the panel rule used by refresh_display :
+SC and SR are EVEN, EC and ER are ODD (so the window width and height are EVEN).
+Overlapping or touching areas are merged when the union does not cost more pixels
+than an extra CASET / RASET / RAMWR window would.
+
+For scattered updates (particles, scatter plots...) the list would only collapse into
+a few huge areas, so a tile mode records the damage in a bitmap of 16 x 16 tiles instead.
+The flush planner then turns the dirty tiles into windows, growing each window over clean
+tiles as long as the overdraw costs less than the window overhead.
+*/
+
+#define AMOLED_DAMAGE_MAX_RECTS    16     // Pending windows before forced merges
+#define AMOLED_WINDOW_OVERHEAD_PX  256    // Cost of one extra window (CASET + RASET + RAMWR) expressed in pixels
+
+#define AMOLED_TILE_SHIFT          4                            // 16 x 16 pixels tiles (EVEN, keeps the panel rule)
+#define AMOLED_TILE_SIZE           (1 << AMOLED_TILE_SHIFT)
+#define AMOLED_TILE_COLS_MAX       64                           // one uint64_t per tile row
+#define AMOLED_TILE_ROWS_MAX       64                           // up to 1024 x 1024 pixels
+
+enum {
+    AMOLED_DAMAGE_RECTS = 0,    // merged rectangle list
+    AMOLED_DAMAGE_TILES,        // tile bitmap
+};
+
+typedef struct _amoled_area_t {
+    uint16_t x0;    // first column (EVEN)
+    uint16_t y0;    // first row (EVEN)
+    uint16_t x1;    // last column (ODD)
+    uint16_t y1;    // last row (ODD)
+} amoled_area_t;
+
+typedef struct _amoled_damage_t {
+    uint8_t mode;                                   // AMOLED_DAMAGE_RECTS or AMOLED_DAMAGE_TILES
+    uint8_t count;                                  // number of pending areas
+    uint32_t overhead;                              // merge slack in pixels
+    amoled_area_t rects[AMOLED_DAMAGE_MAX_RECTS];   // pending areas
+    uint64_t tiles[AMOLED_TILE_ROWS_MAX];           // dirty tiles, bit n of tiles[r] is tile column n of tile row r
+
+    // statistics
+    uint32_t invalidations;     // areas recorded
+    uint32_t merges;            // areas merged into another one (clean tiles sent in tile mode)
+    uint32_t flushes;           // flushes with at least one area
+    uint32_t windows;           // windows sent to the panel
+    uint64_t bytes_naive;       // bytes the per primitive refresh would have sent
+    uint64_t bytes_sent;        // bytes really sent
+    uint64_t bytes_compared;    // frame buffer bytes compared with the shadow frame
+    uint32_t diff_us;           // time spent comparing
+} amoled_damage_t;
+
+void amoled_damage_init(amoled_damage_t *d);
+void amoled_damage_clear(amoled_damage_t *d);
+void amoled_damage_reset_stats(amoled_damage_t *d);
+void amoled_damage_add(amoled_damage_t *d, int x, int y, int w, int h, uint16_t width, uint16_t height);
+bool amoled_damage_align(amoled_area_t *a, int x, int y, int w, int h, uint16_t width, uint16_t height);
+bool amoled_damage_set_mode(amoled_damage_t *d, uint8_t mode, uint16_t width, uint16_t height);
+uint32_t amoled_damage_pending(const amoled_damage_t *d);
+bool amoled_damage_next(amoled_damage_t *d, amoled_area_t *a, uint16_t width, uint16_t height);
+
+static inline uint32_t amoled_area_pixels(const amoled_area_t *a) {
+    return (uint32_t)(a->x1 - a->x0 + 1) * (uint32_t)(a->y1 - a->y0 + 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/* Display list for the AMOLED driver
+
+Plain C, no Micropython dependency : amoled.c records the drawing calls here and
+replays them through the same primitives.
+*/
+
+#include "amoled_dlist.h"
+
+#include <string.h>
+
+void amoled_dlist_init(amoled_dlist_t *d) {
+    memset(d, 0, sizeof(amoled_dlist_t));
+}
+
+// Forget the commands, the buffer is kept for the next recording
+void amoled_dlist_clear(amoled_dlist_t *d) {
+    d->len = 0;
+    d->last = 0;
+    d->count = 0;
+}
+
+// Add a command with an empty bounding box, returns NULL if the buffer is too small
+amoled_dl_cmd_t *amoled_dlist_append(amoled_dlist_t *d, uint8_t op, uint8_t nargs) {
+    size_t size = amoled_dl_cmd_size(nargs);
+
+    if (d->len + size > d->cap) {
+        return NULL;
+    }
+    amoled_dl_cmd_t *cmd = (amoled_dl_cmd_t *)&d->buf[d->len];
+    cmd->op = op;
+    cmd->nargs = nargs;
+    cmd->objs = 0;
+    cmd->bbox.x0 = UINT16_MAX;
+    cmd->bbox.y0 = UINT16_MAX;
+    cmd->bbox.x1 = 0;
+    cmd->bbox.y1 = 0;
+    d->last = d->len;
+    d->len += size;
+    d->count++;
+    return cmd;
+}
+
+// Remove the command just appended, for a call that failed to draw
+void amoled_dlist_drop_last(amoled_dlist_t *d) {
+    if (d->count) {
+        d->len = d->last;
+        d->count--;
+    }
+}
+
+// Grow the bounding box of the command being recorded
+void amoled_dlist_extend(amoled_dlist_t *d, const amoled_area_t *a) {
+    if (d->count == 0) {
+        return;
+    }
+    amoled_dl_cmd_t *cmd = (amoled_dl_cmd_t *)&d->buf[d->last];
+    if (a->x0 < cmd->bbox.x0) {
+        cmd->bbox.x0 = a->x0;
+    }
+    if (a->y0 < cmd->bbox.y0) {
+        cmd->bbox.y0 = a->y0;
+    }
+    if (a->x1 > cmd->bbox.x1) {
+        cmd->bbox.x1 = a->x1;
+    }
+    if (a->y1 > cmd->bbox.y1) {
+        cmd->bbox.y1 = a->y1;
+    }
+}
+
+// Command at *pos, *pos moves to the next one, NULL at the end of the list
+amoled_dl_cmd_t *amoled_dlist_next(const amoled_dlist_t *d, size_t *pos) {
+    if (*pos >= d->len) {
+        return NULL;
+    }
+    amoled_dl_cmd_t *cmd = (amoled_dl_cmd_t *)&d->buf[*pos];
+    *pos += amoled_dl_cmd_size(cmd->nargs);
+    return cmd;
+}
+
+// Bounding box culling : true if the command draws in the clip area
+bool amoled_dlist_hit(const amoled_dl_cmd_t *cmd, const amoled_area_t *clip) {
+    return (cmd->bbox.x0 <= clip->x1) && (clip->x0 <= cmd->bbox.x1) &&
+           (cmd->bbox.y0 <= clip->y1) && (clip->y0 <= cmd->bbox.y1);
+}
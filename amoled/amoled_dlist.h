@@ -0,0 +1,67 @@
+#ifndef __AMOLED_DLIST_H__
+#define __AMOLED_DLIST_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "amoled_damage.h"
+
+/*
+Display list : drawing commands recorded in a compact binary buffer.
+
+Every command is a 12 bytes header followed by its arguments as int32 values. Arguments
+that are not small integers (fonts, strings, point lists...) are stored by the caller in
+an object list and the command keeps their index, bit i of objs tells which ones.
+The bounding box is filled while the command draws, from the areas it damages, so the
+list can be replayed for a clip region only, skipping the commands out of it.
+
+The buffer memory belongs to the caller : amoled_dlist_append returns NULL when the
+buffer is too small, grow it and call again.
+*/
+
+#define AMOLED_DLIST_MAX_ARGS   16      // objs is a 16 bits mask
+
+typedef struct _amoled_dl_cmd_t {
+    uint8_t op;                 // drawing primitive
+    uint8_t nargs;              // arguments following the header
+    uint16_t objs;              // bit i : args[i] is an object list index
+    amoled_area_t bbox;         // area drawn by the command (x0 > x1 if nothing was drawn)
+    int32_t args[];
+} amoled_dl_cmd_t;
+
+typedef struct _amoled_dlist_t {
+    uint8_t *buf;               // commands
+    size_t len;                 // bytes used
+    size_t cap;                 // bytes allocated
+    size_t last;                // offset of the command being recorded
+    uint32_t count;             // commands recorded
+    bool recording;
+    bool drawing;               // the command being recorded draws, its bounding box grows
+
+    // statistics of the last replay
+    uint32_t replayed;          // commands drawn
+    uint32_t culled;            // commands skipped, out of the clip region
+} amoled_dlist_t;
+
+void amoled_dlist_init(amoled_dlist_t *d);
+void amoled_dlist_clear(amoled_dlist_t *d);
+amoled_dl_cmd_t *amoled_dlist_append(amoled_dlist_t *d, uint8_t op, uint8_t nargs);
+void amoled_dlist_drop_last(amoled_dlist_t *d);
+void amoled_dlist_extend(amoled_dlist_t *d, const amoled_area_t *a);
+amoled_dl_cmd_t *amoled_dlist_next(const amoled_dlist_t *d, size_t *pos);
+bool amoled_dlist_hit(const amoled_dl_cmd_t *cmd, const amoled_area_t *clip);
+
+static inline size_t amoled_dl_cmd_size(uint8_t nargs) {
+    return sizeof(amoled_dl_cmd_t) + nargs * sizeof(int32_t);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/* Minimal OS layer for the flush worker : FreeRTOS or pthreads
+*/
+
+#include "amoled_os.h"
+
+#include <stddef.h>
+
+#ifdef ESP_PLATFORM
+
+#define AMOLED_OS_STACK_SIZE 4096
+
+bool amoled_os_lock_init(amoled_os_lock_t *l) {
+    *l = xSemaphoreCreateMutex();
+    return *l != NULL;
+}
+
+void amoled_os_lock_deinit(amoled_os_lock_t *l) {
+    vSemaphoreDelete(*l);
+}
+
+void amoled_os_lock(amoled_os_lock_t *l) {
+    xSemaphoreTake(*l, portMAX_DELAY);
+}
+
+void amoled_os_unlock(amoled_os_lock_t *l) {
+    xSemaphoreGive(*l);
+}
+
+bool amoled_os_sem_init(amoled_os_sem_t *s) {
+    *s = xSemaphoreCreateCounting(0xFFFF, 0);
+    return *s != NULL;
+}
+
+void amoled_os_sem_deinit(amoled_os_sem_t *s) {
+    vSemaphoreDelete(*s);
+}
+
+void amoled_os_sem_give(amoled_os_sem_t *s) {
+    xSemaphoreGive(*s);
+}
+
+void amoled_os_sem_take(amoled_os_sem_t *s) {
+    xSemaphoreTake(*s, portMAX_DELAY);
+}
+
+static void amoled_os_task(void *arg) {
+    amoled_os_thread_t *t = (amoled_os_thread_t *)arg;
+
+    t->fn(t->arg);
+    xSemaphoreGive(t->exited);
+    vTaskDelete(NULL);
+}
+
+// The task runs at the caller priority : it competes with Micropython only on its own core
+bool amoled_os_thread_start(amoled_os_thread_t *t, void (*fn)(void *), void *arg, int core) {
+    t->fn = fn;
+    t->arg = arg;
+    t->exited = xSemaphoreCreateBinary();
+    if (t->exited == NULL) {
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(amoled_os_task, "amoled_flush", AMOLED_OS_STACK_SIZE, t,
+        uxTaskPriorityGet(NULL), &t->task, core) != pdPASS) {
+        vSemaphoreDelete(t->exited);
+        return false;
+    }
+    return true;
+}
+
+void amoled_os_thread_join(amoled_os_thread_t *t) {
+    xSemaphoreTake(t->exited, portMAX_DELAY);
+    vSemaphoreDelete(t->exited);
+}
+
+#else
+
+bool amoled_os_lock_init(amoled_os_lock_t *l) {
+    return pthread_mutex_init(l, NULL) == 0;
+}
+
+void amoled_os_lock_deinit(amoled_os_lock_t *l) {
+    pthread_mutex_destroy(l);
+}
+
+void amoled_os_lock(amoled_os_lock_t *l) {
+    pthread_mutex_lock(l);
+}
+
+void amoled_os_unlock(amoled_os_lock_t *l) {
+    pthread_mutex_unlock(l);
+}
+
+bool amoled_os_sem_init(amoled_os_sem_t *s) {
+    s->count = 0;
+    if (pthread_mutex_init(&s->mutex, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&s->cond, NULL) != 0) {
+        pthread_mutex_destroy(&s->mutex);
+        return false;
+    }
+    return true;
+}
+
+void amoled_os_sem_deinit(amoled_os_sem_t *s) {
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->mutex);
+}
+
+void amoled_os_sem_give(amoled_os_sem_t *s) {
+    pthread_mutex_lock(&s->mutex);
+    s->count++;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+}
+
+void amoled_os_sem_take(amoled_os_sem_t *s) {
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == 0) {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    s->count--;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+static void *amoled_os_thread(void *arg) {
+    amoled_os_thread_t *t = (amoled_os_thread_t *)arg;
+
+    t->fn(t->arg);
+    return NULL;
+}
+
+bool amoled_os_thread_start(amoled_os_thread_t *t, void (*fn)(void *), void *arg, int core) {
+    (void)core;
+    t->fn = fn;
+    t->arg = arg;
+    return pthread_create(&t->thread, NULL, amoled_os_thread, t) == 0;
+}
+
+void amoled_os_thread_join(amoled_os_thread_t *t) {
+    pthread_join(t->thread, NULL);
+}
+
+#endif
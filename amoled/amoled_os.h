@@ -0,0 +1,72 @@
+#ifndef __AMOLED_OS_H__
+#define __AMOLED_OS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+Minimal OS layer used by the flush worker : a lock, a counting semaphore and a thread.
+
+FreeRTOS on ESP32 targets, pthreads everywhere else so the worker queueing logic can be
+run and tested on the unix port.
+*/
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+typedef SemaphoreHandle_t amoled_os_lock_t;
+typedef SemaphoreHandle_t amoled_os_sem_t;
+
+typedef struct _amoled_os_thread_t {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;       // given when the thread function returns, FreeRTOS tasks can not be joined
+    void (*fn)(void *);
+    void *arg;
+} amoled_os_thread_t;
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t amoled_os_lock_t;
+
+typedef struct _amoled_os_sem_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+} amoled_os_sem_t;
+
+typedef struct _amoled_os_thread_t {
+    pthread_t thread;
+    void (*fn)(void *);
+    void *arg;
+} amoled_os_thread_t;
+
+#endif
+
+bool amoled_os_lock_init(amoled_os_lock_t *l);
+void amoled_os_lock_deinit(amoled_os_lock_t *l);
+void amoled_os_lock(amoled_os_lock_t *l);
+void amoled_os_unlock(amoled_os_lock_t *l);
+
+bool amoled_os_sem_init(amoled_os_sem_t *s);
+void amoled_os_sem_deinit(amoled_os_sem_t *s);
+void amoled_os_sem_give(amoled_os_sem_t *s);
+void amoled_os_sem_take(amoled_os_sem_t *s);
+
+// core is a hint : ignored by pthreads
+bool amoled_os_thread_start(amoled_os_thread_t *t, void (*fn)(void *), void *arg, int core);
+void amoled_os_thread_join(amoled_os_thread_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __AMOLED_PANEL_H__
+#define __AMOLED_PANEL_H__
+
+#include "py/obj.h"
+
+/*
+Panel bus protocol of the AMOLED object : QSPIPanel sends to the panel, RecordBus simulates it.
+
+Only depends on Micropython, so a bus can be built without ESP-IDF (unix port).
+*/
+
+typedef struct _amoled_panel_p_t {
+    void (*tx_param)(mp_obj_base_t *self, int lcd_cmd, const void *param, size_t param_size);
+    void (*tx_color)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size);
+    void (*deinit)(mp_obj_base_t *self);
+    // Optional asynchronous transmit : color must stay untouched until wait() for the returned fence
+    uint32_t (*tx_color_async)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size);
+    void (*wait)(mp_obj_base_t *self, uint32_t fence);    // fence 0 waits for every queued transaction
+    bool (*busy)(mp_obj_base_t *self);
+} amoled_panel_p_t;
+
+// Every bus object starts with these fields, the AMOLED object reads the panel size there
+typedef struct _amoled_panel_bus_obj_t {
+    mp_obj_base_t base;
+    mp_obj_base_t *spi_obj;
+    uint16_t width;
+    uint16_t height;
+} amoled_panel_bus_obj_t;
+
+#endif
@@ -0,0 +1,162 @@
+/* Panel model of the RecordBus
+
+Plain C, no Micropython dependency : decodes the commands the driver sends to the panel and
+keeps the resulting GRAM, so the panel content can be compared with the frame buffer.
+*/
+
+#include "amoled_panel_sim.h"
+
+#include <string.h>
+
+// Panel commands decoded here (same values as LCD_CMD_* of amoled.h)
+#define PANEL_CASET     0x2A
+#define PANEL_RASET     0x2B
+#define PANEL_RAMWR     0x2C
+#define PANEL_MADCTL    0x36
+#define PANEL_VSCSAD    0x37
+#define PANEL_COLMOD    0x3A
+#define PANEL_RAMWRC    0x3C
+
+void amoled_panel_sim_init(amoled_panel_sim_t *p, uint8_t *gram, size_t gram_size, uint16_t width, uint16_t height,
+                           amoled_panel_sim_log_t *log, uint32_t log_size) {
+    memset(p, 0, sizeof(amoled_panel_sim_t));
+    p->gram = gram;
+    p->gram_size = gram_size;
+    p->width = width;
+    p->height = height;
+    p->pixel_bytes = 2;
+    p->colmod = 0x55;
+    p->x1 = width - 1;
+    p->y1 = height - 1;
+    p->log = log;
+    p->log_size = log_size;
+    if (gram != NULL) {
+        memset(gram, 0, gram_size);
+    }
+}
+
+void amoled_panel_sim_reset_stats(amoled_panel_sim_t *p) {
+    memset(&p->stats, 0, sizeof(amoled_panel_sim_stats_t));
+    p->logged = 0;
+}
+
+static void log_transaction(amoled_panel_sim_t *p, int cmd, uint8_t color, size_t size) {
+    if (p->log_size != 0) {
+        amoled_panel_sim_log_t *e = &p->log[p->logged % p->log_size];
+        e->cmd = cmd;
+        e->color = color;
+        e->size = size;
+    }
+    p->logged++;
+    p->stats.transactions++;
+    p->stats.bus_bytes += AMOLED_PANEL_SIM_HEADER + size;
+}
+
+static void start_write(amoled_panel_sim_t *p) {
+    p->col = p->x0;
+    p->row = p->y0;
+    p->phase = 0;
+    p->stats.windows++;
+}
+
+void amoled_panel_sim_param(amoled_panel_sim_t *p, int cmd, const void *param, size_t size) {
+    const uint8_t *b = (const uint8_t *)param;
+
+    log_transaction(p, cmd, 0, size);
+    p->stats.commands++;
+    p->stats.param_bytes += size;
+
+    switch (cmd) {
+        case PANEL_CASET:
+            if (size >= 4) {
+                p->x0 = (b[0] << 8) | b[1];
+                p->x1 = (b[2] << 8) | b[3];
+            }
+            break;
+        case PANEL_RASET:
+            if (size >= 4) {
+                p->y0 = (b[0] << 8) | b[1];
+                p->y1 = (b[2] << 8) | b[3];
+            }
+            break;
+        case PANEL_RAMWR:
+            start_write(p);
+            break;
+        case PANEL_MADCTL:
+            if (size >= 1) {
+                p->madctl = b[0];
+            }
+            break;
+        case PANEL_VSCSAD:
+            if (size >= 2) {
+                p->vscsad = (b[0] << 8) | b[1];
+            }
+            break;
+        case PANEL_COLMOD:
+            if (size >= 1) {
+                p->colmod = b[0];
+                p->pixel_bytes = ((b[0] & 0x0F) == 0x05) ? 2 : 3;     // 0x55 / 0x75 16 bpp, 0x66 / 0x77 18 and 24 bpp
+            }
+            break;
+    }
+}
+
+// Pixels go left to right in the window then down, the pointer wraps to the window origin after its last pixel
+void amoled_panel_sim_color(amoled_panel_sim_t *p, int cmd, const void *color, size_t size) {
+    const uint8_t *src = (const uint8_t *)color;
+    uint8_t pb = p->pixel_bytes;
+
+    log_transaction(p, cmd ? cmd : PANEL_RAMWR, 1, size);
+    p->stats.pixel_bytes += size;
+    if ((cmd == 0) || (cmd == PANEL_RAMWR)) {
+        start_write(p);
+    } else if (cmd != PANEL_RAMWRC) {
+        return;
+    }
+    if ((p->x1 < p->x0) || (p->y1 < p->y0)) {
+        p->stats.clipped_bytes += size;
+        return;
+    }
+
+    while (size > 0) {
+        size_t run = (size_t)(p->x1 - p->col + 1) * pb - p->phase;    // bytes up to the end of the window row
+        size_t kept = 0;
+
+        if (run > size) {
+            run = size;
+        }
+        if ((p->gram != NULL) && (p->row < p->height) && (p->col < p->width)) {
+            size_t offset = ((size_t)p->row * p->width + p->col) * pb + p->phase;
+            uint16_t end = (p->x1 < p->width) ? p->x1 + 1 : p->width;
+
+            kept = (size_t)(end - p->col) * pb - p->phase;
+            if (kept > run) {
+                kept = run;
+            }
+            if (offset + kept > p->gram_size) {
+                kept = (offset < p->gram_size) ? p->gram_size - offset : 0;
+            }
+            memcpy(p->gram + offset, src, kept);
+        }
+        p->stats.clipped_bytes += run - kept;
+        src += run;
+        size -= run;
+
+        size_t pos = p->phase + run;
+        p->col += pos / pb;
+        p->phase = pos % pb;
+        if (p->col > p->x1) {
+            p->col = p->x0;
+            p->row = (p->row >= p->y1) ? p->y0 : p->row + 1;
+        }
+    }
+}
+
+uint32_t amoled_panel_sim_log_count(const amoled_panel_sim_t *p) {
+    return (p->logged < p->log_size) ? p->logged : p->log_size;
+}
+
+const amoled_panel_sim_log_t *amoled_panel_sim_log_entry(const amoled_panel_sim_t *p, uint32_t i) {
+    uint32_t first = p->logged - amoled_panel_sim_log_count(p);
+    return &p->log[(first + i) % p->log_size];
+}
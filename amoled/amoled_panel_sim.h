@@ -0,0 +1,77 @@
+#ifndef __AMOLED_PANEL_SIM_H__
+#define __AMOLED_PANEL_SIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+Panel model of the RecordBus : the controller side of the QSPI commands the driver sends.
+
+Plain C, no Micropython dependency, so the host build can count what a drawing call costs on the bus.
+It decodes the window commands (CASET, RASET), the memory writes (RAMWR, RAMWRC) into a simulated GRAM,
+and keeps MADCTL, VSCSAD and COLMOD. The GRAM is the panel memory as addressed : MADCTL and VSCSAD
+change how the panel scans it out, not where the pixels are stored, so they are recorded only.
+Pixel bytes are stored as sent (big endian RGB565 or 3 bytes per pixel), pixels written outside
+the GRAM (x_gap / y_gap offsets of a smaller GRAM) are counted and dropped.
+
+Every transaction is appended to a log ring : the last log_size ones are kept.
+*/
+
+#define AMOLED_PANEL_SIM_HEADER 4   // bytes of a QSPI transaction header : command byte and 24 bits address
+
+typedef struct _amoled_panel_sim_log_t {
+    uint8_t cmd;
+    uint8_t color;              // 1 for a tx_color (memory write), 0 for a tx_param
+    uint32_t size;              // parameter or pixel bytes
+} amoled_panel_sim_log_t;
+
+typedef struct _amoled_panel_sim_stats_t {
+    uint32_t transactions;      // tx_param and tx_color calls
+    uint32_t commands;          // tx_param calls
+    uint32_t windows;           // RAMWR (memory write restarting at the window origin)
+    uint64_t param_bytes;
+    uint64_t pixel_bytes;
+    uint64_t bus_bytes;         // everything on the wire, headers included
+    uint64_t clipped_bytes;     // pixel bytes written outside the GRAM
+} amoled_panel_sim_stats_t;
+
+typedef struct _amoled_panel_sim_t {
+    uint8_t *gram;
+    uint16_t width;             // GRAM columns
+    uint16_t height;            // GRAM rows
+    uint8_t pixel_bytes;        // 2 or 3, from COLMOD
+    size_t gram_size;           // bytes of gram, pixels past it are clipped
+    uint16_t x0, y0, x1, y1;    // window of the last CASET / RASET, inclusive
+    uint16_t col, row;          // write pointer
+    uint8_t phase;              // byte of the current pixel
+    uint8_t madctl;
+    uint8_t colmod;
+    uint16_t vscsad;
+    amoled_panel_sim_log_t *log;
+    uint32_t log_size;
+    uint32_t logged;            // transactions logged so far, entry n is log[n % log_size]
+    amoled_panel_sim_stats_t stats;
+} amoled_panel_sim_t;
+
+void amoled_panel_sim_init(amoled_panel_sim_t *p, uint8_t *gram, size_t gram_size, uint16_t width, uint16_t height,
+                           amoled_panel_sim_log_t *log, uint32_t log_size);
+void amoled_panel_sim_reset_stats(amoled_panel_sim_t *p);
+
+// Same arguments as the amoled_panel_p_t tx_param and tx_color, cmd 0 of tx_color is RAMWR
+void amoled_panel_sim_param(amoled_panel_sim_t *p, int cmd, const void *param, size_t size);
+void amoled_panel_sim_color(amoled_panel_sim_t *p, int cmd, const void *color, size_t size);
+
+// Entry i of the kept log, 0 is the oldest. Returns the number of kept entries
+uint32_t amoled_panel_sim_log_count(const amoled_panel_sim_t *p);
+const amoled_panel_sim_log_t *amoled_panel_sim_log_entry(const amoled_panel_sim_t *p, uint32_t i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,9 @@
 #include "esp_lcd_panel_ops.h"
 #include "soc/soc_caps.h"
 #include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#include "esp_attr.h"
 
 #include "mphalport.h"
 #include "machine_hw_spi.c"
@@ -28,6 +31,29 @@
 Actual functions for qspi transmission.
 */
 
+// Queued transactions drive CS from the SPI driver callbacks, user holds (cs_pin << 2) | flags
+#define QSPI_TRANS_CS_START     (1 << 0)    // lower CS before the transaction
+#define QSPI_TRANS_CS_END       (1 << 1)    // raise CS after the transaction
+
+// The callbacks run in the SPI ISR, kept in IRAM : gpio_set_level is in flash unless CONFIG_GPIO_CTRL_FUNC_IN_IRAM
+// is set and would crash a transfer ending during a flash write, gpio_ll_set_level is inlined
+
+STATIC void IRAM_ATTR hal_lcd_qspi_pre_cb(spi_transaction_t *t)
+{
+    uintptr_t user = (uintptr_t)t->user;
+    if (user & QSPI_TRANS_CS_START) {
+        gpio_ll_set_level(&GPIO, user >> 2, 0);
+    }
+}
+
+STATIC void IRAM_ATTR hal_lcd_qspi_post_cb(spi_transaction_t *t)
+{
+    uintptr_t user = (uintptr_t)t->user;
+    if (user & QSPI_TRANS_CS_END) {
+        gpio_ll_set_level(&GPIO, user >> 2, 1);
+    }
+}
+
 void hal_lcd_qspi_panel_construct(mp_obj_base_t *self)
 {
     amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
@@ -65,12 +91,83 @@ void hal_lcd_qspi_panel_construct(mp_obj_base_t *self)
         .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX,
         .queue_size = 10,
+        .pre_cb = hal_lcd_qspi_pre_cb,
+        .post_cb = hal_lcd_qspi_post_cb,
     };
 
     ret = spi_bus_add_device(spi_obj->host, &devcfg, &spi_obj->spi);
     if (ret != 0) {
         mp_raise_msg_varg(&mp_type_OSError, "%d(spi_bus_add_device)", ret);
     }
+    qspi_panel_obj->queued = 0;
+    qspi_panel_obj->done = 0;
+#if AMOLED_STATS
+    memset(&qspi_panel_obj->stats, 0, sizeof(amoled_stats_t));
+#endif
+}
+
+
+// Collect one finished queued transaction
+STATIC void hal_lcd_qspi_panel_reap(amoled_qspi_bus_obj_t *qspi_panel_obj)
+{
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_t *t;
+
+    AMOLED_STATS_START(start);
+    spi_device_get_trans_result(spi_obj->spi, &t, portMAX_DELAY);
+    qspi_panel_obj->done++;
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, queue_waits, 1);
+    AMOLED_STATS_STOP(&qspi_panel_obj->stats, tx_us, start);
+}
+
+
+STATIC void hal_lcd_qspi_panel_wait(mp_obj_base_t *self, uint32_t fence)
+{
+    amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
+
+    if (fence == 0) {
+        fence = qspi_panel_obj->queued;
+    }
+    while ((int32_t)(fence - qspi_panel_obj->done) > 0) {
+        hal_lcd_qspi_panel_reap(qspi_panel_obj);
+    }
+}
+
+
+STATIC bool hal_lcd_qspi_panel_busy(mp_obj_base_t *self)
+{
+    amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_t *t;
+
+    while ((qspi_panel_obj->queued != qspi_panel_obj->done) &&
+           (spi_device_get_trans_result(spi_obj->spi, &t, 0) == ESP_OK)) {
+        qspi_panel_obj->done++;
+    }
+    return qspi_panel_obj->queued != qspi_panel_obj->done;
+}
+
+
+// Queue a transaction, the ring slot is recycled once its previous transaction is collected
+STATIC spi_transaction_ext_t *hal_lcd_qspi_panel_slot(amoled_qspi_bus_obj_t *qspi_panel_obj)
+{
+    if (qspi_panel_obj->queued - qspi_panel_obj->done >= QSPI_QUEUE_DEPTH) {
+        hal_lcd_qspi_panel_reap(qspi_panel_obj);
+    }
+    spi_transaction_ext_t *t = &qspi_panel_obj->trans[qspi_panel_obj->queued % QSPI_QUEUE_DEPTH];
+    memset(t, 0, sizeof(spi_transaction_ext_t));
+    return t;
+}
+
+
+STATIC void hal_lcd_qspi_panel_queue(amoled_qspi_bus_obj_t *qspi_panel_obj, spi_transaction_ext_t *t, uintptr_t cs_flags)
+{
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+
+    t->base.user = (void *)(((uintptr_t)qspi_panel_obj->cs_pin << 2) | cs_flags);
+    spi_device_queue_trans(spi_obj->spi, (spi_transaction_t *)t, portMAX_DELAY);
+    qspi_panel_obj->queued++;
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, transactions, 1);
 }
 
 
@@ -83,6 +180,27 @@ STATIC void hal_lcd_qspi_panel_tx_param(mp_obj_base_t *self,
 
     amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, commands, 1);
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, param_bytes, param_size);
+    if (qspi_panel_obj->queued != qspi_panel_obj->done) {
+        if (param_size <= 4) {
+            // Keep the order with queued memory writes, short parameters are copied in the transaction
+            spi_transaction_ext_t *tq = hal_lcd_qspi_panel_slot(qspi_panel_obj);
+            tq->base.flags = (SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR);
+            tq->base.cmd = 0x02;
+            tq->base.addr = lcd_cmd << 8;
+            if (param_size != 0) {
+                tq->base.flags |= SPI_TRANS_USE_TXDATA;
+                memcpy(tq->base.tx_data, param, param_size);
+                tq->base.length = qspi_panel_obj->cmd_bits * param_size;
+            }
+            hal_lcd_qspi_panel_queue(qspi_panel_obj, tq, QSPI_TRANS_CS_START | QSPI_TRANS_CS_END);
+            return;
+        }
+        hal_lcd_qspi_panel_wait(self, 0);
+    }
+
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
     t.flags = (SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR);
@@ -95,14 +213,17 @@ STATIC void hal_lcd_qspi_panel_tx_param(mp_obj_base_t *self,
         t.tx_buffer = NULL;
         t.length = 0;
     }
+    AMOLED_STATS_START(start);
     mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
     spi_device_polling_transmit(spi_obj->spi, &t);
     mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, transactions, 1);
+    AMOLED_STATS_STOP(&qspi_panel_obj->stats, tx_us, start);
 }
 
 
 STATIC void hal_lcd_qspi_panel_tx_color(mp_obj_base_t *self,			// tx_color(self->bus_obj, 0, buf, len);	
-                                        int            lcd_cmd,			// 0 in below command
+                                        int            lcd_cmd,			// memory command, 0 for LCD_CMD_RAMWR
                                         const void    *color,			// pointer to color buffer (full character for example)
                                         size_t         color_size)		// size of color buffer
 {
@@ -112,11 +233,15 @@ STATIC void hal_lcd_qspi_panel_tx_color(mp_obj_base_t *self,			// tx_color(self-
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);  // spi_obj is pointer to spi 
     spi_transaction_ext_t t;															// t is spi transactionner
 
+    hal_lcd_qspi_panel_wait(self, 0);						// polling transmit needs an empty queue
+
+    AMOLED_STATS_START(start);
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, pixel_bytes, color_size);
     mp_hal_pin_od_low(qspi_panel_obj->cs_pin);				// Activate SPI bus transfert by CS_Pin 
     memset(&t, 0, sizeof(t));
     t.base.flags = SPI_TRANS_MODE_QIO;
     t.base.cmd = 0x32;
-    t.base.addr = 0x002C00;									// 2C00 is the memory write adress (LCD_CMD_RAMWR)
+    t.base.addr = (lcd_cmd ? lcd_cmd : 0x2C) << 8;			// 2C00 is the memory write adress (LCD_CMD_RAMWR), 3C00 continues it (LCD_CMD_RAMWRC)
     spi_device_polling_transmit(spi_obj->spi, (spi_transaction_t *)&t);
 
     uint8_t *p_color = (uint8_t *)color;					// p_color is the dynamic pointer to color buffer
@@ -140,16 +265,58 @@ STATIC void hal_lcd_qspi_panel_tx_color(mp_obj_base_t *self,			// tx_color(self-
         t.base.tx_buffer = p_color;
         t.base.length = chunk_size * 8;					//  /!\   *8 for bits 
         spi_device_polling_transmit(spi_obj->spi, (spi_transaction_t *)&t);
+        AMOLED_STATS_ADD(&qspi_panel_obj->stats, transactions, 1);
         len -= chunk_size;									// next chunk if it was over buffer max length
         p_color += chunk_size;
     } while (len > 0);
 
     mp_hal_pin_od_high(qspi_panel_obj->cs_pin);				// Desactivate SPI bus transfert by CS_Pin 
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, transactions, 1);	// memory write command
+    AMOLED_STATS_STOP(&qspi_panel_obj->stats, tx_us, start);
+}
+
+
+// Same as hal_lcd_qspi_panel_tx_color but returns as soon as the chunks are queued
+// color must not change until hal_lcd_qspi_panel_wait() for the returned fence
+STATIC uint32_t hal_lcd_qspi_panel_tx_color_async(mp_obj_base_t *self,
+                                                  int            lcd_cmd,
+                                                  const void    *color,
+                                                  size_t         color_size)
+{
+    amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
+    spi_transaction_ext_t *t;
+
+    AMOLED_STATS_ADD(&qspi_panel_obj->stats, pixel_bytes, color_size);
+    t = hal_lcd_qspi_panel_slot(qspi_panel_obj);
+    t->base.flags = SPI_TRANS_MODE_QIO;
+    t->base.cmd = 0x32;
+    t->base.addr = (lcd_cmd ? lcd_cmd : 0x2C) << 8;
+    hal_lcd_qspi_panel_queue(qspi_panel_obj, t, (color_size == 0) ? (QSPI_TRANS_CS_START | QSPI_TRANS_CS_END) : QSPI_TRANS_CS_START);
+
+    const uint8_t *p_color = (const uint8_t *)color;
+    size_t chunk_size;
+    size_t len = color_size;
+
+    while (len > 0) {
+        chunk_size = (len > SEND_BUF_SIZE) ? SEND_BUF_SIZE : len;
+        t = hal_lcd_qspi_panel_slot(qspi_panel_obj);
+        t->base.flags = SPI_TRANS_MODE_QIO | \
+                        SPI_TRANS_VARIABLE_CMD | \
+                        SPI_TRANS_VARIABLE_ADDR | \
+                        SPI_TRANS_VARIABLE_DUMMY;
+        t->base.tx_buffer = p_color;
+        t->base.length = chunk_size * 8;
+        len -= chunk_size;
+        p_color += chunk_size;
+        hal_lcd_qspi_panel_queue(qspi_panel_obj, t, (len == 0) ? QSPI_TRANS_CS_END : 0);
+    }
+    return qspi_panel_obj->queued;
 }
 
 
 STATIC void hal_lcd_qspi_panel_deinit(mp_obj_base_t *self)
 {
+    hal_lcd_qspi_panel_wait(self, 0);
     amoled_qspi_bus_obj_t *qspi_panel_obj = (amoled_qspi_bus_obj_t *)self;
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
     
@@ -276,6 +443,50 @@ STATIC mp_obj_t amoled_qspi_bus_tx_color(size_t n_args, const mp_obj_t *args_in)
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_qspi_bus_tx_color_obj, 2, 3, amoled_qspi_bus_tx_color);
 
 
+// Transfer statistics as a dict, shared with the AMOLED object
+mp_obj_t amoled_stats_dict(const amoled_stats_t *stats)
+{
+    mp_obj_t dict = mp_obj_new_dict(0);
+#if AMOLED_STATS
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_transactions), mp_obj_new_int_from_uint(stats->transactions));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_commands), mp_obj_new_int_from_uint(stats->commands));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_allocations), mp_obj_new_int_from_uint(stats->allocations));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_queue_waits), mp_obj_new_int_from_uint(stats->queue_waits));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_param_bytes), mp_obj_new_int_from_ull(stats->param_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_pixel_bytes), mp_obj_new_int_from_ull(stats->pixel_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_staging_bytes), mp_obj_new_int_from_ull(stats->staging_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_tx_us), mp_obj_new_int_from_ull(stats->tx_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_copy_us), mp_obj_new_int_from_ull(stats->copy_us));
+#else
+    (void)stats;
+#endif
+    return dict;
+}
+
+
+STATIC mp_obj_t amoled_qspi_bus_stats(mp_obj_t self_in)
+{
+#if AMOLED_STATS
+    amoled_qspi_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return amoled_stats_dict(&self->stats);
+#else
+    return amoled_stats_dict(NULL);
+#endif
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_qspi_bus_stats_obj, amoled_qspi_bus_stats);
+
+
+STATIC mp_obj_t amoled_qspi_bus_reset_stats(mp_obj_t self_in)
+{
+#if AMOLED_STATS
+    amoled_qspi_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    memset(&self->stats, 0, sizeof(amoled_stats_t));
+#endif
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_qspi_bus_reset_stats_obj, amoled_qspi_bus_reset_stats);
+
+
 STATIC mp_obj_t amoled_qspi_bus_deinit(mp_obj_t self_in)
 {
     mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(self_in);
@@ -290,6 +501,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_qspi_bus_deinit_obj, amoled_qspi_bus_dei
 STATIC const mp_rom_map_elem_t amoled_qspi_bus_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_tx_param), MP_ROM_PTR(&amoled_qspi_bus_tx_param_obj) },
     { MP_ROM_QSTR(MP_QSTR_tx_color), MP_ROM_PTR(&amoled_qspi_bus_tx_color_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats),    MP_ROM_PTR(&amoled_qspi_bus_stats_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats), MP_ROM_PTR(&amoled_qspi_bus_reset_stats_obj) },
     { MP_ROM_QSTR(MP_QSTR_deinit),   MP_ROM_PTR(&amoled_qspi_bus_deinit_obj)   },
     { MP_ROM_QSTR(MP_QSTR___del__),  MP_ROM_PTR(&amoled_qspi_bus_deinit_obj)   },
 };
@@ -299,7 +512,10 @@ STATIC MP_DEFINE_CONST_DICT(amoled_qspi_bus_locals_dict, amoled_qspi_bus_locals_
 STATIC const amoled_panel_p_t mp_lcd_panel_p = {
     .tx_param = hal_lcd_qspi_panel_tx_param,
     .tx_color = hal_lcd_qspi_panel_tx_color,
-    .deinit = hal_lcd_qspi_panel_deinit
+    .deinit = hal_lcd_qspi_panel_deinit,
+    .tx_color_async = hal_lcd_qspi_panel_tx_color_async,
+    .wait = hal_lcd_qspi_panel_wait,
+    .busy = hal_lcd_qspi_panel_busy
 };
 
 
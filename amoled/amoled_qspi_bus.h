@@ -5,14 +5,13 @@
 #include "py/obj.h"
 #include "esp_lcd_panel_io.h"
 #include "driver/spi_master.h"
+#include "amoled_stats.h"
+#include "amoled_panel.h"
 
-typedef struct _amoled_panel_p_t {
-    void (*tx_param)(mp_obj_base_t *self, int lcd_cmd, const void *param, size_t param_size);
-    void (*tx_color)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size);
-    void (*deinit)(mp_obj_base_t *self);
-} amoled_panel_p_t;
+#define QSPI_QUEUE_DEPTH 8   // Transactions kept in flight by the asynchronous transmit (device queue_size is 10)
 
 typedef struct _amoled_qspi_bus_obj_t {
+    // starts like amoled_panel_bus_obj_t
     mp_obj_base_t base;
     mp_obj_base_t *spi_obj;
     uint16_t width;
@@ -31,6 +30,14 @@ typedef struct _amoled_qspi_bus_obj_t {
     int param_bits;
 
     // spi_device_handle_t io_handle;
+    // Asynchronous transmit ring, transaction n uses trans[n % QSPI_QUEUE_DEPTH]
+    spi_transaction_ext_t trans[QSPI_QUEUE_DEPTH];
+    uint32_t queued;        // transactions queued so far
+    uint32_t done;          // transactions completed so far
+#if AMOLED_STATS
+    amoled_stats_t stats;
+#endif
+
     enum {
         MACHINE_HW_QSPI_STATE_NONE,
         MACHINE_HW_QSPI_STATE_INIT,
@@ -40,4 +47,6 @@ typedef struct _amoled_qspi_bus_obj_t {
 
 extern const mp_obj_type_t amoled_qspi_bus_type;
 
+mp_obj_t amoled_stats_dict(const amoled_stats_t *stats);
+
 #endif
@@ -0,0 +1,784 @@
+/* Rendering core of the AMOLED driver
+
+Plain C, no Micropython nor ESP-IDF dependency. The primitives are the ones of the original
+amoled.c, moved here unchanged apart from drawing into a surface.
+*/
+
+#include <string.h>
+#include <limits.h>
+
+#include "amoled_raster.h"
+#include "amoled_blit.h"
+
+#define _swap_int16_t(a, b) { int16_t t = a; a = b; b = t; }
+#define _swap_int(a, b) { int t = a; a = b; b = t; }
+#define ABS(N) (((N) < 0) ? (-(N)) : (N))
+
+static int maxx(uint16_t x1, uint16_t x2) {
+	return (x1 > x2) ? x1 : x2;
+}
+
+static int minx(uint16_t x1, uint16_t x2) {
+	return (x1 < x2) ? x1 : x2;
+}
+
+void amoled_surface_init(amoled_surface_t *s, uint16_t *pixels, uint16_t width, uint16_t height, uint8_t pixel_bits) {
+	memset(s, 0, sizeof(amoled_surface_t));
+	s->pixels = pixels;
+	s->width = width;
+	s->height = height;
+	s->pixel_bits = pixel_bits;
+	amoled_surface_clip_reset(s);
+}
+
+// Clip region back to the whole surface
+void amoled_surface_clip_reset(amoled_surface_t *s) {
+	s->clip.x0 = 0;
+	s->clip.y0 = 0;
+	s->clip.x1 = s->width - 1;
+	s->clip.y1 = s->height - 1;
+}
+
+// Row holding the logical row y (differs only inside a ring addressed scroll region)
+int amoled_surface_row(const amoled_surface_t *s, int y) {
+	int ry = y - s->scroll_top;
+	if (s->scroll_rows && (ry >= 0) && (ry < s->scroll_rows)) {
+		ry += s->scroll_offset;
+		if (ry >= s->scroll_rows) {
+			ry -= s->scroll_rows;
+		}
+		return s->scroll_top + ry;
+	}
+	return y;
+}
+
+// Index of the logical pixel x, y
+size_t amoled_surface_index(const amoled_surface_t *s, int x, int y) {
+	return ((size_t)amoled_surface_row(s, y) * s->width) + x;
+}
+
+static inline bool clip_contains(const amoled_surface_t *s, int x, int y) {
+	return (x >= s->clip.x0) & (x <= s->clip.x1) & (y >= s->clip.y0) & (y <= s->clip.y1);
+}
+
+// True if x, y, w, h is entirely inside the clip region : per pixel checks can be skipped
+static inline bool clip_holds(const amoled_surface_t *s, int x, int y, int w, int h) {
+	return (x >= s->clip.x0) & (x + w - 1 <= s->clip.x1) & (y >= s->clip.y0) & (y + h - 1 <= s->clip.y1);
+}
+
+// Tell the owner of the surface an area is about to be written
+void amoled_surface_damage(amoled_surface_t *s, int x, int y, int w, int h) {
+	if (s->damage) {
+		s->damage(s->ctx, x, y, w, h);
+	}
+}
+
+// Write the pixel idx : color is RGB565, or a palette index in an indexed surface
+// A monochrome surface sets the pixel for any color but 0
+void amoled_raster_put(amoled_surface_t *s, size_t idx, uint16_t color) {
+	if (s->pixel_bits == 16) {
+		s->pixels[idx] = color;
+	} else if (s->pixel_bits == 8) {
+		((uint8_t *)s->pixels)[idx] = color;
+	} else if (s->pixel_bits == 4) {
+		uint8_t *p = &((uint8_t *)s->pixels)[idx >> 1];
+		*p = (idx & 1) ? ((*p & 0xF0) | (color & 0x0F)) : ((*p & 0x0F) | (color << 4));
+	} else {
+		uint8_t *p = &((uint8_t *)s->pixels)[idx >> 3];
+		uint8_t mask = 0x80 >> (idx & 7);
+		*p = color ? (*p | mask) : (*p & ~mask);
+	}
+}
+
+// Write 8 monochrome pixels from idx, bit 7 of bits first : whole bytes instead of 8 pixel writes
+static inline void put8(amoled_surface_t *s, size_t idx, uint8_t bits) {
+	uint8_t *p = &((uint8_t *)s->pixels)[idx >> 3];
+	uint8_t shift = idx & 7;
+
+	if (shift == 0) {
+		*p = bits;
+	} else {
+		p[0] = (p[0] & (0xFF << (8 - shift))) | (bits >> shift);
+		p[1] = (p[1] & (0xFF >> shift)) | (bits << (8 - shift));
+	}
+}
+
+// Fill len pixels from idx
+void amoled_raster_span(amoled_surface_t *s, size_t idx, size_t len, uint16_t color) {
+	if (s->pixel_bits == 16) {
+		amoled_blit_fill16(&s->pixels[idx], color, len);
+	} else if (s->pixel_bits == 8) {
+		memset(&((uint8_t *)s->pixels)[idx], color, len);
+	} else if (s->pixel_bits == 1) {
+		// ends share their byte with pixels outside the span
+		while ((idx & 7) && len) {
+			amoled_raster_put(s, idx++, color);
+			len--;
+		}
+		memset(&((uint8_t *)s->pixels)[idx >> 3], color ? 0xFF : 0x00, len >> 3);
+		idx += len & ~7;
+		len &= 7;
+		while (len--) {
+			amoled_raster_put(s, idx++, color);
+		}
+	} else {
+		// odd ends share their byte with a pixel outside the span
+		if ((idx & 1) && len) {
+			amoled_raster_put(s, idx++, color);
+			len--;
+		}
+		memset(&((uint8_t *)s->pixels)[idx >> 1], (color & 0x0F) * 0x11, len >> 1);
+		if (len & 1) {
+			amoled_raster_put(s, idx + len - 1, color);
+		}
+	}
+}
+
+// Fill an area, keeping the part inside the clip region
+void amoled_raster_fill(amoled_surface_t *s, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+	int x1 = ((x + w - 1) > s->clip.x1) ? s->clip.x1 : (x + w - 1);
+	int y1 = ((y + h - 1) > s->clip.y1) ? s->clip.y1 : (y + h - 1);
+	x = (x < s->clip.x0) ? s->clip.x0 : x;
+	y = (y < s->clip.y0) ? s->clip.y0 : y;
+	if ((x1 < x) | (y1 < y)) {
+		return;
+	}
+	w = x1 - x + 1;
+	h = y1 - y + 1;
+
+	amoled_surface_damage(s, x, y, w, h);
+	for (uint16_t line = 0; line < h; line++) {
+		amoled_raster_span(s, amoled_surface_index(s, x, y + line), w, color);
+	}
+}
+
+void amoled_raster_pixel(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t color) {
+	if (clip_contains(s, x, y)) {
+		amoled_surface_damage(s, x, y, 1, 1);
+		amoled_raster_put(s, amoled_surface_index(s, x, y), color);
+	}
+}
+
+void amoled_raster_hline(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t len, uint16_t color) {
+	if ((x <= s->width - 1) & (y <= s->height - 1) & (len > 0)) {
+		if (x + len > s->width) {
+			len = s->width - x;
+		}
+		amoled_raster_fill(s, color, x, y, len, 1);
+	}
+}
+
+void amoled_raster_vline(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t len, uint16_t color) {
+	if ((x <= s->width - 1) & (y <= s->height - 1) & (len > 0)) {
+		if (y + len > s->height) {
+			len = s->height - y;
+		}
+		amoled_raster_fill(s, color, x, y, 1, len);
+	}
+}
+
+// Run of a line : its ends may be off the surface, clip them before the unsigned hline / vline
+static void line_run(amoled_surface_t *s, int x, int y, int len, bool vertical, uint16_t color) {
+	int *start = vertical ? &y : &x;
+	int size = vertical ? s->height : s->width;
+
+	if (*start < 0) {
+		len += *start;
+		*start = 0;
+	}
+	if ((len <= 0) | (x < 0) | (y < 0) | (x >= s->width) | (y >= s->height)) {
+		return;
+	}
+	if (len > size) {
+		len = size;
+	}
+	if (vertical) {
+		amoled_raster_vline(s, x, y, len, color);
+	} else {
+		amoled_raster_hline(s, x, y, len, color);
+	}
+}
+
+// Bresenham in int : ends off the surface (negative ones included) are clipped, not wrapped
+void amoled_raster_line(amoled_surface_t *s, int x0, int y0, int x1, int y1, uint16_t color) {
+	bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+
+	if (steep) {
+		_swap_int(x0, y0);
+		_swap_int(x1, y1);
+	}
+
+	if (x0 > x1) {
+		_swap_int(x0, x1);
+		_swap_int(y0, y1);
+	}
+
+	int dx = x1 - x0, dy = ABS(y1 - y0);
+	int err = dx >> 1, ystep = -1, xs = x0, dlen = 0;
+
+	if (y0 < y1) {
+		ystep = 1;
+	}
+
+	// Split into steep and not steep for FastH/V separation
+	for (; x0 <= x1; x0++) {
+		dlen++;
+		err -= dy;
+		if (err < 0) {
+			err += dx;
+			if (steep) {
+				line_run(s, y0, xs, dlen, true, color);
+			} else {
+				line_run(s, xs, y0, dlen, false, color);
+			}
+			dlen = 0;
+			y0 += ystep;
+			xs = x0 + 1;
+		}
+	}
+	if (dlen) {
+		if (steep) {
+			line_run(s, y0, xs, dlen, true, color);
+		} else {
+			line_run(s, xs, y0, dlen, false, color);
+		}
+	}
+}
+
+void amoled_raster_rect(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	if (x + w > s->width || y + h > s->height || w == 0 || h == 0) {
+		return;
+	}
+	if (h == 1) {
+		amoled_raster_hline(s, x, y, w, color);
+		return;
+	}
+	if (w == 1) {
+		amoled_raster_vline(s, x, y, h, color);
+		return;
+	}
+	amoled_raster_hline(s, x, y, w, color);
+	amoled_raster_hline(s, x, y + h - 1, w, color);
+	amoled_raster_vline(s, x, y, h, color);
+	amoled_raster_vline(s, x + w - 1, y, h, color);
+}
+
+void amoled_raster_fill_rect(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	if (x + w > s->width || y + h > s->height || w == 0 || h == 0) {
+		return;
+	}
+	amoled_raster_fill(s, color, x, y, w, h);
+}
+
+void amoled_raster_trian(amoled_surface_t *s, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color) {
+	amoled_raster_line(s, x0, y0, x1, y1, color);
+	amoled_raster_line(s, x1, y1, x2, y2, color);
+	amoled_raster_line(s, x0, y0, x2, y2, color);
+}
+
+void amoled_raster_fill_trian(amoled_surface_t *s, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color) {
+	uint16_t xmin = minx(minx(x0, x1), x2);
+	uint16_t xmax = maxx(maxx(x0, x1), x2);
+	float dx02;
+	float dx01;
+	float dx12;
+	float x01;
+	float x02;
+	float x12;
+
+	//Sort corners by y value (y0 < y1 < y2)
+	if (y1 < y0) {
+		_swap_int16_t(x0, x1);
+		_swap_int16_t(y0, y1);
+	}
+	if (y2 < y0) {
+		_swap_int16_t(x0, x2);
+		_swap_int16_t(y0, y2);
+	}
+	if (y2 < y1) {
+		_swap_int16_t(x1, x2);
+		_swap_int16_t(y1, y2);
+	}
+
+	if (y2 == y0) {
+		amoled_raster_hline(s, xmin, y0, xmax - xmin, color);
+		return;
+	}
+
+	dx02 = (float)(x2 - x0) / (float)(y2 - y0);
+	x02 = x0;
+	x01 = x0;
+	/*Check if triangle has flat bottom*/
+	if (y1 > y0) {
+		dx01 = (float)(x1 - x0) / (float)(y1 - y0);
+		for (uint16_t y = y0; y <= y1; y++) {
+			if (x01 <= x02) {
+				amoled_raster_hline(s, (int)x01, y, (int)(x02 - x01), color);
+			} else {
+				amoled_raster_hline(s, (int)x02, y, (int)(x01 - x02), color);
+			}
+			x02 += dx02;
+			x01 += dx01;
+		}
+	}
+	/*Check if triangle has flat top*/
+	if (y2 > y1) {
+		dx12 = (float)(x2 - x1) / (float)(y2 - y1);
+		x12 = x1 + dx12; //we alreardy proceed up to y1 so
+		for (uint16_t y = y1 + 1; y <= y2; y++) {
+			if (x02 <= x12) {
+				amoled_raster_hline(s, (int)x02, y, (int)(x12 - x02), color);
+			} else {
+				amoled_raster_hline(s, (int)x12, y, (int)(x02 - x12), color);
+			}
+			x02 += dx02;
+			x12 += dx12;
+		}
+	}
+}
+
+void amoled_raster_bubble_rect(amoled_surface_t *s, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color) {
+	if (xs + w > s->width || ys + h > s->height) {
+		return;
+	}
+	int bubble_size = (w < h) ? w / 4 : h / 4;
+	int xm = xs + bubble_size;
+	int ym = ys + bubble_size;
+	int x = 0;
+	int y = bubble_size;
+	int p = 1 - bubble_size;
+
+	if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))) {
+		return;
+	}
+	amoled_raster_hline(s, xs + bubble_size - 1, ys, w - bubble_size * 2, color);
+	amoled_raster_hline(s, xs + bubble_size - 1, ys + h - 1, w - bubble_size * 2, color);
+	amoled_raster_vline(s, xs, ys + bubble_size - 1, h - bubble_size * 2, color);
+	amoled_raster_vline(s, xs + w - 1, ys + bubble_size - 1, h - bubble_size * 2, color);
+
+	while (x <= y) {
+		// top left
+		amoled_raster_pixel(s, xm - x, ym - y, color);
+		amoled_raster_pixel(s, xm - y, ym - x, color);
+
+		// top right
+		amoled_raster_pixel(s, xm + w - bubble_size * 2 + x - 1, ym - y, color);
+		amoled_raster_pixel(s, xm + w - bubble_size * 2 + y - 1, ym - x, color);
+
+		// bottom left
+		amoled_raster_pixel(s, xm - x, ym + h - bubble_size * 2 + y - 1, color);
+		amoled_raster_pixel(s, xm - y, ym + h - bubble_size * 2 + x - 1, color);
+
+		// bottom right
+		amoled_raster_pixel(s, xm + w - bubble_size * 2 + x - 1, ym + h - bubble_size * 2 + y - 1, color);
+		amoled_raster_pixel(s, xm + w - bubble_size * 2 + y - 1, ym + h - bubble_size * 2 + x - 1, color);
+
+		if (p < 0) {
+			p += 2 * x + 3;
+		} else {
+			p += 2 * (x - y) + 5;
+			y -= 1;
+		}
+		x += 1;
+	}
+}
+
+void amoled_raster_fill_bubble_rect(amoled_surface_t *s, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color) {
+	if (xs + w > s->width || ys + h > s->height) {
+		return;
+	}
+	int bubble_size = (w < h) ? w / 4 : h / 4;
+	int xm = xs + bubble_size;
+	int ym = ys + bubble_size;
+	int x = 0;
+	int y = bubble_size;
+	int p = 1 - bubble_size;
+
+	if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))) {
+		return;
+	}
+	amoled_raster_fill_rect(s, xs, ys + bubble_size - 1, w, h - bubble_size * 2, color);
+
+	while (x <= y) {
+		// top left to right
+		amoled_raster_hline(s, xm - x, ym - y, w - bubble_size * 2 + x * 2 - 1, color);
+		amoled_raster_hline(s, xm - y, ym - x, w - bubble_size * 2 + y * 2 - 1, color);
+
+		// bottom left to right
+		amoled_raster_hline(s, xm - x, ym + h - bubble_size * 2 + y - 1, w - bubble_size * 2 + x * 2 - 1, color);
+		amoled_raster_hline(s, xm - y, ym + h - bubble_size * 2 + x - 1, w - bubble_size * 2 + y * 2 - 1, color);
+
+		if (p < 0) {
+			p += 2 * x + 3;
+		} else {
+			p += 2 * (x - y) + 5;
+			y -= 1;
+		}
+		x += 1;
+	}
+}
+
+void amoled_raster_circle(amoled_surface_t *s, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color) {
+	int x = 0;
+	int y = r;
+	int p = 1 - r;
+
+	while (x <= y) {
+		amoled_raster_pixel(s, xm + x, ym + y, color);
+		amoled_raster_pixel(s, xm + x, ym - y, color);
+		amoled_raster_pixel(s, xm - x, ym + y, color);
+		amoled_raster_pixel(s, xm - x, ym - y, color);
+		amoled_raster_pixel(s, xm + y, ym + x, color);
+		amoled_raster_pixel(s, xm + y, ym - x, color);
+		amoled_raster_pixel(s, xm - y, ym + x, color);
+		amoled_raster_pixel(s, xm - y, ym - x, color);
+
+		if (p < 0) {
+			p += 2 * x + 3;
+		} else {
+			p += 2 * (x - y) + 5;
+			y -= 1;
+		}
+		x += 1;
+	}
+}
+
+void amoled_raster_fill_circle(amoled_surface_t *s, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color) {
+	int x = 0;
+	int y = r;
+	int p = 1 - r;
+
+	while (x <= y) {
+		amoled_raster_vline(s, xm + x, ym - y, 2 * y, color);
+		amoled_raster_vline(s, xm - x, ym - y, 2 * y, color);
+		amoled_raster_vline(s, xm + y, ym - x, 2 * x, color);
+		amoled_raster_vline(s, xm - y, ym - x, 2 * x, color);
+
+		if (p < 0) {
+			p += 2 * x + 3;
+		} else {
+			p += 2 * (x - y) + 5;
+			y -= 1;
+		}
+		x += 1;
+	}
+}
+
+// public-domain code by Darel Rex Finley, 2007 https://alienryderflex.com/polygon_fill/
+bool amoled_raster_fill_polygon(amoled_surface_t *s, const amoled_point_t *points, int n, int x, int y, uint16_t color) {
+	int nodes, nodeX[AMOLED_RASTER_MAX_POLY_CORNERS], pixelY, i, j, swap;
+
+	int minX = INT_MAX;
+	int maxX = INT_MIN;
+	int minY = INT_MAX;
+	int maxY = INT_MIN;
+
+	for (i = 0; i < n; i++) {
+		if (points[i].x < minX) {
+			minX = (int)points[i].x;
+		}
+		if (points[i].x > maxX) {
+			maxX = (int)points[i].x;
+		}
+		if (points[i].y < minY) {
+			minY = (int)points[i].y;
+		}
+		if (points[i].y > maxY) {
+			maxY = (int)points[i].y;
+		}
+	}
+
+	//  Loop through the rows
+	for (pixelY = minY; pixelY < maxY; pixelY++) {
+		//  Build a list of nodes.
+		nodes = 0;
+		j = n - 1;
+		for (i = 0; i < n; i++) {
+			if ((points[i].y < pixelY && points[j].y >= pixelY) ||
+				(points[j].y < pixelY && points[i].y >= pixelY)) {
+				if (nodes == AMOLED_RASTER_MAX_POLY_CORNERS) {
+					return false;
+				}
+				nodeX[nodes++] = (int)(points[i].x +
+					(pixelY - points[i].y) /
+					(points[j].y - points[i].y) *
+					(points[j].x - points[i].x));
+			}
+			j = i;
+		}
+
+		//  Sort the nodes, via a simple “Bubble” sort.
+		i = 0;
+		while (i < nodes - 1) {
+			if (nodeX[i] > nodeX[i + 1]) {
+				swap = nodeX[i];
+				nodeX[i] = nodeX[i + 1];
+				nodeX[i + 1] = swap;
+				if (i) {
+					i--;
+				}
+			} else {
+				i++;
+			}
+		}
+		//  Fill the pixels between node pairs.
+		for (i = 0; i < nodes; i += 2) {
+			if (nodeX[i] >= maxX) {
+				break;
+			}
+			if (nodeX[i + 1] > minX) {
+				if (nodeX[i] < minX) {
+					nodeX[i] = minX;
+				}
+				if (nodeX[i + 1] > maxX) {
+					nodeX[i + 1] = maxX;
+				}
+				amoled_raster_hline(s, x + nodeX[i], y + pixelY, nodeX[i + 1] - nodeX[i] + 1, color);
+			}
+		}
+	}
+	return true;
+}
+
+void amoled_raster_copy(amoled_surface_t *s, int x, int y, int w, int h, const uint16_t *src) {
+	bool clip_all = clip_holds(s, x, y, w, h);
+
+	amoled_surface_damage(s, x, y, w, h);
+	for (int line = 0; line < h; line++) {
+		uint16_t *dst = &s->pixels[amoled_surface_index(s, x, y + line)];
+		if (clip_all) {
+			memcpy(dst, src, 2 * w);
+		} else {
+			for (int col = 0; col < w; col++) {
+				if (clip_contains(s, x + col, y + line)) {
+					dst[col] = src[col];
+				}
+			}
+		}
+		src += w;
+	}
+}
+
+int amoled_raster_text(amoled_surface_t *s, const amoled_font_t *font, const uint8_t *str, size_t len, int x, int y,
+                       uint16_t fg, uint16_t bg) {
+	uint8_t wide = font->width / 8;     // bytes per glyph row (ex 16 bits large font is 2 bytes per line)
+	// monochrome surface : a font byte maps to 8 pixels, bg + fg select how (0, data, ~data or 0xFF)
+	bool mono = (s->pixel_bits == 1);
+	uint8_t mono_fg = fg ? 0xFF : 0x00;
+	uint8_t mono_bg = bg ? 0xFF : 0x00;
+
+	while (len--) {
+		uint8_t chr = *str++;
+		if (chr < font->first || chr > font->last) {
+			continue;
+		}
+		if (x + font->width > s->width - 1) {
+			break;      // char is away from the surface
+		}
+		uint16_t chr_idx = (chr - font->first) * (font->height * wide);
+		bool clip_all = clip_holds(s, x, y, font->width, font->height);     // no per pixel clip check needed
+		amoled_surface_damage(s, x, y, font->width, font->height);
+		for (uint8_t line = 0; line < font->height; line++) {
+			size_t buf_idx = amoled_surface_index(s, x, y + line);
+			for (uint8_t line_byte = 0; line_byte < wide; line_byte++) {
+				uint8_t chr_data = font->data[chr_idx++];
+				if (mono && clip_all) {
+					put8(s, buf_idx, (chr_data & mono_fg) | (~chr_data & mono_bg));
+					buf_idx += 8;
+					continue;
+				}
+				for (uint8_t bit = 8; bit; bit--) {
+					if (clip_all || clip_contains(s, x + (line_byte * 8) + 8 - bit, y + line)) {
+						amoled_raster_put(s, buf_idx, ((chr_data >> (bit - 1)) & 1) ? fg : bg);
+					}
+					buf_idx++;
+				}
+			}
+		}
+		x += font->width;
+	}
+	return x;
+}
+
+// Next bpp bits of the glyph bitmap from bit *bs_bit
+static uint8_t glyph_bits(const uint8_t *bitmaps, uint32_t *bs_bit, uint8_t bpp) {
+	uint8_t color = 0;
+
+	for (uint8_t i = 0; i < bpp; i++) {
+		color <<= 1;
+		color |= (bitmaps[*bs_bit / 8] & 1 << (7 - (*bs_bit % 8))) > 0;
+		(*bs_bit)++;
+	}
+	return color;
+}
+
+bool amoled_raster_glyph(amoled_surface_t *s, const amoled_pfont_t *font, uint16_t index, int x, int y,
+                         uint16_t fg, uint16_t bg) {
+	uint8_t width = font->widths[index];
+	const uint8_t *offset = &font->offsets[index * font->offset_width];
+	uint32_t bs_bit = 0;
+
+	if (x + width > s->width - 1) {
+		return false;   // char is away from the surface
+	}
+	for (uint8_t i = 0; i < font->offset_width; i++) {
+		bs_bit = (bs_bit << 8) | offset[i];
+	}
+
+	bool clip_all = clip_holds(s, x, y, width, font->height);
+	amoled_surface_damage(s, x, y, width, font->height);
+	for (uint16_t line = 0; line < font->height; line++) {
+		size_t buf_idx = amoled_surface_index(s, x, y + line);
+		for (uint16_t line_bits = 0; line_bits < width; line_bits++) {
+			uint16_t color;
+			if (font->background && (line_bits <= font->background_width && line <= font->background_height)) {
+				if (glyph_bits(font->bitmaps, &bs_bit, font->bpp) == bg) {
+					color = font->background[(line * font->background_width + line_bits)];
+				} else {
+					color = fg;
+				}
+			} else {
+				color = glyph_bits(font->bitmaps, &bs_bit, font->bpp) ? fg : bg;
+			}
+			if (clip_all || clip_contains(s, x + line_bits, y + line)) {
+				amoled_raster_put(s, buf_idx, color);
+			}
+			buf_idx++;
+		}
+	}
+	return true;
+}
+
+void amoled_raster_draw(amoled_surface_t *s, const uint8_t *index, const int8_t *font, const char *str,
+                        int x, int y, uint16_t color, float scale) {
+	int16_t from_x = x;
+	int16_t from_y = y;
+	int16_t to_x = x;
+	int16_t to_y = y;
+	int16_t pos_x = x;
+	int16_t pos_y = y;
+	bool penup = true;
+	char c;
+	int16_t ii;
+
+	while ((c = *str++)) {
+		if (c >= 32 && c <= 127) {
+			ii = (c - 32) * 2;
+
+			int16_t offset = index[ii] | (index[ii + 1] << 8);
+			int16_t length = font[offset++];
+			int16_t left = (int)(scale * (font[offset++] - 0x52) + 0.5);
+			int16_t right = (int)(scale * (font[offset++] - 0x52) + 0.5);
+			int16_t width = right - left;
+
+			if (length) {
+				int16_t i;
+				for (i = 0; i < length; i++) {
+					if (font[offset] == ' ') {
+						offset += 2;
+						penup = true;
+						continue;
+					}
+
+					int16_t vector_x = (int)(scale * (font[offset++] - 0x52) + 0.5);
+					int16_t vector_y = (int)(scale * (font[offset++] - 0x52) + 0.5);
+
+					if (!i || penup) {
+						from_x = pos_x + vector_x - left;
+						from_y = pos_y + vector_y;
+					} else {
+						to_x = pos_x + vector_x - left;
+						to_y = pos_y + vector_y;
+
+						amoled_raster_line(s, from_x, from_y, to_x, to_y, color);
+						from_x = to_x;
+						from_y = to_y;
+					}
+					penup = false;
+				}
+			}
+			pos_x += width;
+		}
+	}
+}
+
+// Keep the part of a w x h source placed at x, y that is inside clip : first source column sx and row sy,
+// destination x, y and size w, h
+static bool blit_clip(const amoled_area_t *clip, int *sx, int *sy, int *x, int *y, int *w, int *h) {
+	int x0 = (*x > clip->x0) ? *x : clip->x0;
+	int y0 = (*y > clip->y0) ? *y : clip->y0;
+	int x1 = ((*x + *w - 1) < clip->x1) ? (*x + *w - 1) : clip->x1;
+	int y1 = ((*y + *h - 1) < clip->y1) ? (*y + *h - 1) : clip->y1;
+
+	*sx = x0 - *x;
+	*sy = y0 - *y;
+	*x = x0;
+	*y = y0;
+	*w = x1 - x0 + 1;
+	*h = y1 - y0 + 1;
+	return (*w > 0) && (*h > 0);
+}
+
+bool amoled_raster_blit(amoled_surface_t *s, const amoled_surface_t *src, int x, int y, int32_t key, uint8_t alpha,
+                        amoled_area_t *area) {
+	int w = src->width;
+	int h = src->height;
+	int sx, sy;
+
+	if ((src == s) || !blit_clip(&s->clip, &sx, &sy, &x, &y, &w, &h)) {
+		return false;
+	}
+	amoled_surface_damage(s, x, y, w, h);
+	for (int row = 0; row < h; row++) {
+		amoled_blit_compose(&s->pixels[amoled_surface_index(s, x, y + row)],
+			&src->pixels[((sy + row) * src->width) + sx], w, key, alpha);
+	}
+	area->x0 = x;
+	area->y0 = y;
+	area->x1 = x + w - 1;
+	area->y1 = y + h - 1;
+	return true;
+}
+
+// Copy the decompressed RGB565 rectangle to the picture buffer
+// returns 1:Ok, 0:Aborted
+int amoled_jpg_out_fast(JDEC *jd, void *bitmap, JRECT *rect) {
+	amoled_jpg_out_t *dev = (amoled_jpg_out_t *)jd->device;
+	uint8_t *src = (uint8_t *)bitmap;
+	uint8_t *dst = dev->fbuf + 2 * (rect->top * dev->wfbuf + rect->left);  // left-top of the destination rectangle
+	uint16_t bws = 2 * (rect->right - rect->left + 1);                     // width of the source rectangle [byte]
+	uint16_t bwd = 2 * dev->wfbuf;                                         // width of the picture buffer [byte]
+
+	for (uint16_t y = rect->top; y <= rect->bottom; y++) {
+		memcpy(dst, src, bws);
+		src += bws;
+		dst += bwd;
+	}
+	return 1;     // Continue to decompress
+}
+
+// Copy the part of the decompressed rectangle inside the crop window, fbuf holds the window only
+int amoled_jpg_out_crop(JDEC *jd, void *bitmap, JRECT *rect) {
+	amoled_jpg_out_t *dev = (amoled_jpg_out_t *)jd->device;
+
+	if (dev->left <= rect->right &&
+		dev->right >= rect->left &&
+		dev->top <= rect->bottom &&
+		dev->bottom >= rect->top) {
+		uint16_t left = (dev->left > rect->left) ? dev->left : rect->left;
+		uint16_t top = (dev->top > rect->top) ? dev->top : rect->top;
+		uint16_t right = (dev->right < rect->right) ? dev->right : rect->right;
+		uint16_t bottom = (dev->bottom < rect->bottom) ? dev->bottom : rect->bottom;
+		uint16_t dev_width = dev->right - dev->left + 1;
+		uint16_t rect_width = rect->right - rect->left + 1;
+		uint16_t width = (right - left + 1) * 2;
+
+		for (uint16_t row = top; row <= bottom; row++) {
+			memcpy(
+				(uint16_t *)dev->fbuf + ((row - dev->top) * dev_width) + left - dev->left,
+				(uint16_t *)bitmap + ((row - rect->top) * rect_width) + left - rect->left,
+				width);
+		}
+	}
+	return 1;     // Continue to decompress
+}
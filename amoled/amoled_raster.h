@@ -0,0 +1,135 @@
+#ifndef __AMOLED_RASTER_H__
+#define __AMOLED_RASTER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "amoled_damage.h"
+#include "jpg/tjpgd565.h"
+
+/*
+Rendering core : the drawing primitives, font blitters and jpg output of the AMOLED driver.
+
+Plain C, no Micropython nor ESP-IDF dependency, so it builds and can be benchmarked on a host
+(see CMakeLists.txt at the top of the repository). amoled.c parses the arguments, calls these
+functions on its render target and sends what they damaged.
+
+Every primitive draws into a surface, clipped to its clip region. Before writing an area it
+calls the surface damage hook (when set) with it : the display records the area to send and
+waits for the flush worker there. Coordinates keep the unsigned 16 bits arithmetic of the
+original driver : negative values wrap, except for line() which clips them.
+*/
+
+#define AMOLED_RASTER_MAX_POLY_CORNERS 32
+
+// Render target of the drawing primitives : the frame buffer or an off-screen Surface
+typedef struct _amoled_surface_t {
+    uint16_t *pixels;
+    uint16_t width;
+    uint16_t height;
+    uint8_t pixel_bits;         // 16 (RGB565), 8 / 4 (palette indexes) or 1 (monochrome)
+    amoled_area_t clip;         // area the primitives may draw into
+    // Ring addressed scroll region : logical row y in [scroll_top, scroll_top + scroll_rows) is stored in
+    // row scroll_top + (y - scroll_top + scroll_offset) % scroll_rows, as the panel VSCSAD shows it
+    uint16_t scroll_top;
+    uint16_t scroll_rows;       // 0 when the rows are not ring addressed
+    uint16_t scroll_offset;
+    void (*damage)(void *ctx, int x, int y, int w, int h);     // called before an area is written, or NULL
+    void *ctx;
+} amoled_surface_t;
+
+typedef struct _amoled_point_t {
+    float x;
+    float y;
+} amoled_point_t;
+
+// Monospaced bitmap font of text() : 1 bit per pixel, rows of width / 8 bytes, glyphs first to last
+typedef struct _amoled_font_t {
+    const uint8_t *data;
+    uint8_t width;
+    uint8_t height;
+    uint8_t first;
+    uint8_t last;
+} amoled_font_t;
+
+// Proportional font of write() : glyph i is widths[i] x height pixels of bpp bits packed from bit offsets[i]
+// (offset_width bytes, big endian) of bitmaps. A background is drawn where the glyph pixel is bg
+typedef struct _amoled_pfont_t {
+    const uint8_t *bitmaps;
+    const uint8_t *widths;
+    const uint8_t *offsets;
+    uint8_t offset_width;
+    uint8_t height;
+    uint8_t bpp;
+    const uint16_t *background;     // optional background pixels, NULL for none
+    uint16_t background_width;
+    uint16_t background_height;
+} amoled_pfont_t;
+
+// jpg output device : the jd_prepare device must start with it
+typedef struct _amoled_jpg_out_t {
+    uint8_t *fbuf;              // decoded RGB565 pixels
+    unsigned int wfbuf;         // width of fbuf [pix]
+    unsigned int left;          // crop window of amoled_jpg_out_crop
+    unsigned int top;
+    unsigned int right;
+    unsigned int bottom;
+} amoled_jpg_out_t;
+
+void amoled_surface_init(amoled_surface_t *s, uint16_t *pixels, uint16_t width, uint16_t height, uint8_t pixel_bits);
+void amoled_surface_clip_reset(amoled_surface_t *s);
+int amoled_surface_row(const amoled_surface_t *s, int y);
+size_t amoled_surface_index(const amoled_surface_t *s, int x, int y);
+void amoled_surface_damage(amoled_surface_t *s, int x, int y, int w, int h);
+
+void amoled_raster_put(amoled_surface_t *s, size_t idx, uint16_t color);
+void amoled_raster_span(amoled_surface_t *s, size_t idx, size_t len, uint16_t color);
+
+void amoled_raster_fill(amoled_surface_t *s, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void amoled_raster_pixel(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t color);
+void amoled_raster_hline(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t len, uint16_t color);
+void amoled_raster_vline(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t len, uint16_t color);
+void amoled_raster_line(amoled_surface_t *s, int x0, int y0, int x1, int y1, uint16_t color);
+void amoled_raster_rect(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void amoled_raster_fill_rect(amoled_surface_t *s, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void amoled_raster_trian(amoled_surface_t *s, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);
+void amoled_raster_fill_trian(amoled_surface_t *s, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);
+void amoled_raster_bubble_rect(amoled_surface_t *s, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color);
+void amoled_raster_fill_bubble_rect(amoled_surface_t *s, uint16_t xs, uint16_t ys, uint16_t w, uint16_t h, uint16_t color);
+void amoled_raster_circle(amoled_surface_t *s, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color);
+void amoled_raster_fill_circle(amoled_surface_t *s, uint16_t xm, uint16_t ym, uint16_t r, uint16_t color);
+// false if a row crosses more than AMOLED_RASTER_MAX_POLY_CORNERS edges
+bool amoled_raster_fill_polygon(amoled_surface_t *s, const amoled_point_t *points, int n, int x, int y, uint16_t color);
+
+// Copy w x h RGB565 pixels to x, y, clipped
+void amoled_raster_copy(amoled_surface_t *s, int x, int y, int w, int h, const uint16_t *src);
+
+// Compose the RGB565 surface src at x, y (see amoled_blit_compose for key and alpha), clipped
+// false if nothing was drawn, area is the part written otherwise
+bool amoled_raster_blit(amoled_surface_t *s, const amoled_surface_t *src, int x, int y, int32_t key, uint8_t alpha,
+                        amoled_area_t *area);
+
+// Font blitters : they return the x following the last glyph drawn, and stop at the first one off the right edge
+int amoled_raster_text(amoled_surface_t *s, const amoled_font_t *font, const uint8_t *str, size_t len, int x, int y,
+                       uint16_t fg, uint16_t bg);
+// glyph of write() : false if it does not fit, nothing drawn
+bool amoled_raster_glyph(amoled_surface_t *s, const amoled_pfont_t *font, uint16_t index, int x, int y,
+                         uint16_t fg, uint16_t bg);
+// Hershey vector font of draw()
+void amoled_raster_draw(amoled_surface_t *s, const uint8_t *index, const int8_t *font, const char *str,
+                        int x, int y, uint16_t color, float scale);
+
+// tjpgd565 output functions : whole picture to fbuf (out_fast), or its crop window only (out_crop)
+int amoled_jpg_out_fast(JDEC *jd, void *bitmap, JRECT *rect);
+int amoled_jpg_out_crop(JDEC *jd, void *bitmap, JRECT *rect);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,322 @@
+#include "amoled_record_bus.h"
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include <string.h>
+
+#if MICROPY_VERSION >= MICROPY_MAKE_VERSION(1, 23, 0) // STATIC should be replaced with static.
+#undef STATIC   // This may become irrelevant later on.
+#define STATIC static
+#endif
+
+/*
+Panel protocol : every call goes to the panel model, nothing is queued
+*/
+
+STATIC void record_bus_tx_param(mp_obj_base_t *self, int lcd_cmd, const void *param, size_t param_size)
+{
+    amoled_record_bus_obj_t *bus = (amoled_record_bus_obj_t *)self;
+    amoled_panel_sim_param(&bus->sim, lcd_cmd, param, param_size);
+}
+
+
+STATIC void record_bus_tx_color(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size)
+{
+    amoled_record_bus_obj_t *bus = (amoled_record_bus_obj_t *)self;
+    amoled_panel_sim_color(&bus->sim, lcd_cmd, color, color_size);
+}
+
+
+// Completes before returning, so async_refresh runs unchanged on the RecordBus
+STATIC uint32_t record_bus_tx_color_async(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size)
+{
+    amoled_record_bus_obj_t *bus = (amoled_record_bus_obj_t *)self;
+    amoled_panel_sim_color(&bus->sim, lcd_cmd, color, color_size);
+    return ++bus->fence;
+}
+
+
+STATIC void record_bus_wait(mp_obj_base_t *self, uint32_t fence)
+{
+    (void)self;
+    (void)fence;
+}
+
+
+STATIC bool record_bus_busy(mp_obj_base_t *self)
+{
+    (void)self;
+    return false;
+}
+
+
+// Nothing to release : the GRAM and the log stay readable after the AMOLED object deinit
+STATIC void record_bus_deinit(mp_obj_base_t *self)
+{
+    (void)self;
+}
+
+
+STATIC void amoled_record_bus_print(const mp_print_t *print,
+                                    mp_obj_t          self_in,
+                                    mp_print_kind_t   kind)
+{
+    (void) kind;
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(
+        print,
+        "<RecordBus width=%u, height=%u, pixel_bytes=%u, transactions=%u>",
+        self->width,
+        self->height,
+        self->sim.pixel_bytes,
+        self->sim.stats.transactions
+    );
+}
+
+
+STATIC mp_obj_t amoled_record_bus_make_new(const mp_obj_type_t *type,
+                                           size_t               n_args,
+                                           size_t               n_kw,
+                                           const mp_obj_t      *all_args)
+{
+    enum {
+        ARG_width,
+        ARG_height,
+        ARG_bpp,
+        ARG_log
+    };
+    const mp_arg_t make_new_args[] = {
+        { MP_QSTR_width,            MP_ARG_INT | MP_ARG_KW_ONLY | MP_ARG_REQUIRED        },
+        { MP_QSTR_height,           MP_ARG_INT | MP_ARG_KW_ONLY | MP_ARG_REQUIRED        },
+        { MP_QSTR_bpp,              MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 16         } },
+        { MP_QSTR_log,              MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 256        } },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(make_new_args)];
+    mp_arg_parse_all_kw_array(
+        n_args,
+        n_kw,
+        all_args,
+        MP_ARRAY_SIZE(make_new_args),
+        make_new_args, args
+    );
+
+    mp_int_t width = args[ARG_width].u_int;
+    mp_int_t height = args[ARG_height].u_int;
+    mp_int_t log_size = args[ARG_log].u_int;
+    if ((width <= 0) || (width > 0xFFFF) || (height <= 0) || (height > 0xFFFF)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid width or height"));
+    }
+    if ((args[ARG_bpp].u_int != 16) && (args[ARG_bpp].u_int != 18) && (args[ARG_bpp].u_int != 24)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bpp must be 16, 18 or 24"));
+    }
+    if (log_size < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("log must be >= 0"));
+    }
+
+    // the GRAM holds 3 bytes per pixel when the bus is set for 18 or 24 bpp pixels (COLMOD)
+    size_t gram_size = (size_t)width * height * ((args[ARG_bpp].u_int == 16) ? 2 : 3);
+
+    amoled_record_bus_obj_t *self = m_new_obj(amoled_record_bus_obj_t);
+    self->base.type = &amoled_record_bus_type;
+    self->spi_obj = NULL;
+    self->width = width;
+    self->height = height;
+    self->fence = 0;
+    amoled_panel_sim_init(&self->sim, m_new(uint8_t, gram_size), gram_size, width, height,
+                          (log_size > 0) ? m_new(amoled_panel_sim_log_t, log_size) : NULL, log_size);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+
+STATIC mp_obj_t amoled_record_bus_tx_param(size_t n_args, const mp_obj_t *args_in)
+{
+    mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(args_in[0]);
+    int cmd = mp_obj_get_int(args_in[1]);
+    if (n_args == 3) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args_in[2], &bufinfo, MP_BUFFER_READ);
+        record_bus_tx_param(self, cmd, bufinfo.buf, bufinfo.len);
+    } else {
+        record_bus_tx_param(self, cmd, NULL, 0);
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_record_bus_tx_param_obj, 2, 3, amoled_record_bus_tx_param);
+
+
+STATIC mp_obj_t amoled_record_bus_tx_color(size_t n_args, const mp_obj_t *args_in)
+{
+    mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(args_in[0]);
+    int cmd = mp_obj_get_int(args_in[1]);
+
+    if (n_args == 3) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args_in[2], &bufinfo, MP_BUFFER_READ);
+        record_bus_tx_color(self, cmd, bufinfo.buf, bufinfo.len);
+    } else {
+        record_bus_tx_color(self, cmd, NULL, 0);
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(amoled_record_bus_tx_color_obj, 2, 3, amoled_record_bus_tx_color);
+
+
+// Counters since the last reset_stats()
+STATIC mp_obj_t amoled_record_bus_stats(mp_obj_t self_in)
+{
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    const amoled_panel_sim_stats_t *stats = &self->sim.stats;
+    mp_obj_t dict = mp_obj_new_dict(0);
+
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_transactions), mp_obj_new_int_from_uint(stats->transactions));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_commands), mp_obj_new_int_from_uint(stats->commands));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_windows), mp_obj_new_int_from_uint(stats->windows));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_param_bytes), mp_obj_new_int_from_ull(stats->param_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_pixel_bytes), mp_obj_new_int_from_ull(stats->pixel_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bus_bytes), mp_obj_new_int_from_ull(stats->bus_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_clipped_bytes), mp_obj_new_int_from_ull(stats->clipped_bytes));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_stats_obj, amoled_record_bus_stats);
+
+
+// Clears the counters and the log, the GRAM is kept
+STATIC mp_obj_t amoled_record_bus_reset_stats(mp_obj_t self_in)
+{
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    amoled_panel_sim_reset_stats(&self->sim);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_reset_stats_obj, amoled_record_bus_reset_stats);
+
+
+// Transactions kept since the last reset_stats(), oldest first : list of (cmd, size, is_color)
+STATIC mp_obj_t amoled_record_bus_log(mp_obj_t self_in)
+{
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    uint32_t count = amoled_panel_sim_log_count(&self->sim);
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const amoled_panel_sim_log_t *e = amoled_panel_sim_log_entry(&self->sim, i);
+        mp_obj_t items[3] = {
+            MP_OBJ_NEW_SMALL_INT(e->cmd),
+            mp_obj_new_int_from_uint(e->size),
+            mp_obj_new_bool(e->color)
+        };
+        mp_obj_list_append(list, mp_obj_new_tuple(3, items));
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_log_obj, amoled_record_bus_log);
+
+
+// The simulated panel memory, rows of width pixels as sent (big endian RGB565, or 3 bytes per pixel)
+STATIC mp_obj_t amoled_record_bus_gram(mp_obj_t self_in)
+{
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    size_t len = (size_t)self->width * self->height * self->sim.pixel_bytes;
+
+    if (len > self->sim.gram_size) {
+        len = self->sim.gram_size;
+    }
+    return mp_obj_new_bytearray_by_ref(len, self->sim.gram);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_gram_obj, amoled_record_bus_gram);
+
+
+// Panel registers decoded so far
+STATIC mp_obj_t amoled_record_bus_state(mp_obj_t self_in)
+{
+    amoled_record_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    const amoled_panel_sim_t *sim = &self->sim;
+    mp_obj_t dict = mp_obj_new_dict(0);
+    mp_obj_t window[4] = {
+        MP_OBJ_NEW_SMALL_INT(sim->x0),
+        MP_OBJ_NEW_SMALL_INT(sim->y0),
+        MP_OBJ_NEW_SMALL_INT(sim->x1),
+        MP_OBJ_NEW_SMALL_INT(sim->y1)
+    };
+
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_window), mp_obj_new_tuple(4, window));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_madctl), MP_OBJ_NEW_SMALL_INT(sim->madctl));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_vscsad), MP_OBJ_NEW_SMALL_INT(sim->vscsad));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_colmod), MP_OBJ_NEW_SMALL_INT(sim->colmod));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_pixel_bytes), MP_OBJ_NEW_SMALL_INT(sim->pixel_bytes));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_state_obj, amoled_record_bus_state);
+
+
+STATIC mp_obj_t amoled_record_bus_deinit(mp_obj_t self_in)
+{
+    record_bus_deinit((mp_obj_base_t *)MP_OBJ_TO_PTR(self_in));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(amoled_record_bus_deinit_obj, amoled_record_bus_deinit);
+
+
+STATIC const mp_rom_map_elem_t amoled_record_bus_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_tx_param),    MP_ROM_PTR(&amoled_record_bus_tx_param_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_tx_color),    MP_ROM_PTR(&amoled_record_bus_tx_color_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_stats),       MP_ROM_PTR(&amoled_record_bus_stats_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats), MP_ROM_PTR(&amoled_record_bus_reset_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_log),         MP_ROM_PTR(&amoled_record_bus_log_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_gram),        MP_ROM_PTR(&amoled_record_bus_gram_obj)        },
+    { MP_ROM_QSTR(MP_QSTR_state),       MP_ROM_PTR(&amoled_record_bus_state_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_deinit),      MP_ROM_PTR(&amoled_record_bus_deinit_obj)      },
+};
+STATIC MP_DEFINE_CONST_DICT(amoled_record_bus_locals_dict, amoled_record_bus_locals_dict_table);
+
+
+STATIC const amoled_panel_p_t record_bus_panel_p = {
+    .tx_param = record_bus_tx_param,
+    .tx_color = record_bus_tx_color,
+    .deinit = record_bus_deinit,
+    .tx_color_async = record_bus_tx_color_async,
+    .wait = record_bus_wait,
+    .busy = record_bus_busy
+};
+
+
+#ifdef MP_OBJ_TYPE_GET_SLOT
+MP_DEFINE_CONST_OBJ_TYPE(
+    amoled_record_bus_type,
+    MP_QSTR_RecordBus,
+    MP_TYPE_FLAG_NONE,
+    print, amoled_record_bus_print,
+    make_new, amoled_record_bus_make_new,
+    protocol, &record_bus_panel_p,
+    locals_dict, (mp_obj_dict_t *)&amoled_record_bus_locals_dict
+);
+#else
+const mp_obj_type_t amoled_record_bus_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_RecordBus,
+    .print = amoled_record_bus_print,
+    .make_new = amoled_record_bus_make_new,
+    .protocol = &record_bus_panel_p,
+    .locals_dict = (mp_obj_dict_t *)&amoled_record_bus_locals_dict,
+};
+#endif
+
+
+#ifdef AMOLED_RECORD_BUS_ONLY
+// Unix port build (micropython.mk with AMOLED_RECORD_BUS_ONLY=1) : the display driver needs ESP-IDF,
+// the amoled module only holds the RecordBus there
+STATIC const mp_rom_map_elem_t mp_module_amoled_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__),   MP_ROM_QSTR(MP_QSTR_amoled)          },
+    { MP_ROM_QSTR(MP_QSTR_RecordBus),  MP_ROM_PTR(&amoled_record_bus_type)  },
+};
+STATIC MP_DEFINE_CONST_DICT(mp_module_amoled_globals, mp_module_amoled_globals_table);
+
+const mp_obj_module_t mp_module_amoled = {
+    .base    = {&mp_type_module},
+    .globals = (mp_obj_dict_t *)&mp_module_amoled_globals,
+};
+
+MP_REGISTER_MODULE(MP_QSTR_amoled, mp_module_amoled);
+#endif
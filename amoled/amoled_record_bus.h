@@ -0,0 +1,29 @@
+#ifndef __AMOLED_RECORD_BUS_H__
+#define __AMOLED_RECORD_BUS_H__
+
+#include "py/obj.h"
+#include "amoled_panel.h"
+#include "amoled_panel_sim.h"
+
+/*
+RecordBus : a panel bus without hardware, drop-in replacement of QSPIPanel for the AMOLED object.
+
+It feeds every transaction to the panel model of amoled_panel_sim.c, so tests can compare the
+simulated GRAM with the frame buffer and count the bytes and transactions of a drawing call.
+Only depends on Micropython : it also builds on the unix port.
+*/
+
+typedef struct _amoled_record_bus_obj_t {
+    // starts like amoled_panel_bus_obj_t
+    mp_obj_base_t base;
+    mp_obj_base_t *spi_obj;     // always NULL
+    uint16_t width;
+    uint16_t height;
+
+    amoled_panel_sim_t sim;
+    uint32_t fence;             // tx_color_async calls, they complete at once
+} amoled_record_bus_obj_t;
+
+extern const mp_obj_type_t amoled_record_bus_type;
+
+#endif
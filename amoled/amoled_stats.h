@@ -0,0 +1,70 @@
+#ifndef __AMOLED_STATS_H__
+#define __AMOLED_STATS_H__
+
+#include <stdint.h>
+
+/*
+Transfer statistics of the AMOLED and QSPIPanel objects.
+
+Build with AMOLED_STATS=0 to compile them out : the counters disappear from the objects,
+every macro below expands to nothing and stats() returns an empty dict.
+*/
+
+#ifndef AMOLED_STATS
+#define AMOLED_STATS (1)
+#endif
+
+typedef struct _amoled_stats_t {
+    uint32_t transactions;      // memory writes (AMOLED) or SPI transactions (QSPIPanel)
+    uint32_t commands;          // register writes
+    uint32_t allocations;       // buffers allocated by the driver
+    uint32_t queue_waits;       // waits for a queued transaction to complete
+    uint64_t param_bytes;       // register parameter bytes
+    uint64_t pixel_bytes;       // pixel bytes sent
+    uint64_t staging_bytes;     // pixel bytes copied to the staging buffers
+    uint64_t tx_us;             // time spent transmitting (queueing only in async mode)
+    uint64_t copy_us;           // time spent copying to the staging buffers
+} amoled_stats_t;
+
+// Add the counters of src to dst
+static inline void amoled_stats_merge(amoled_stats_t *dst, const amoled_stats_t *src) {
+    dst->transactions += src->transactions;
+    dst->commands += src->commands;
+    dst->allocations += src->allocations;
+    dst->queue_waits += src->queue_waits;
+    dst->param_bytes += src->param_bytes;
+    dst->pixel_bytes += src->pixel_bytes;
+    dst->staging_bytes += src->staging_bytes;
+    dst->tx_us += src->tx_us;
+    dst->copy_us += src->copy_us;
+}
+
+#if AMOLED_STATS
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#define AMOLED_STATS_NOW()                  ((uint32_t)esp_timer_get_time())
+#else
+// the flush worker is also built on the host (unix port, host tests)
+#include <time.h>
+static inline uint32_t amoled_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+#define AMOLED_STATS_NOW()                  amoled_stats_now()
+#endif
+
+#define AMOLED_STATS_ADD(s, field, n)       ((s)->field += (n))
+#define AMOLED_STATS_START(t)               uint32_t t = AMOLED_STATS_NOW()
+#define AMOLED_STATS_STOP(s, field, t)      ((s)->field += AMOLED_STATS_NOW() - (t))
+
+#else
+
+#define AMOLED_STATS_ADD(s, field, n)
+#define AMOLED_STATS_START(t)
+#define AMOLED_STATS_STOP(s, field, t)
+
+#endif
+
+#endif
@@ -0,0 +1,171 @@
+/* Flush worker for the AMOLED driver
+
+Plain C, no Micropython dependency : the worker thread must never call the Micropython
+runtime, it only runs the send function given to amoled_worker_start.
+*/
+
+#include "amoled_worker.h"
+
+#include <string.h>
+
+static inline bool area_overlap(const amoled_area_t *a, const amoled_area_t *b) {
+    return (a->x0 <= b->x1) && (b->x0 <= a->x1) && (a->y0 <= b->y1) && (b->y0 <= a->y1);
+}
+
+static void counters_add(amoled_worker_counters_t *dst, const amoled_worker_counters_t *src) {
+#if AMOLED_STATS
+    amoled_stats_merge(&dst->stats, &src->stats);
+#endif
+    dst->windows += src->windows;
+    dst->bytes_sent += src->bytes_sent;
+}
+
+static void worker_loop(void *arg) {
+    amoled_worker_t *w = (amoled_worker_t *)arg;
+
+    for (;;) {
+        amoled_os_sem_take(&w->jobs);
+        amoled_os_lock(&w->lock);
+        if (w->count == 0) {
+            // stop is only honoured once the queue is empty
+            bool stop = w->stop;
+            amoled_os_unlock(&w->lock);
+            if (stop) {
+                return;
+            }
+            continue;
+        }
+        w->current = w->queue[w->head];
+        w->head = (w->head + 1) % AMOLED_WORKER_QUEUE;
+        w->count--;
+        w->sending = true;
+        amoled_os_unlock(&w->lock);
+
+        amoled_worker_counters_t counters;
+        memset(&counters, 0, sizeof(counters));
+        w->fn(w->ctx, &w->current, &counters);
+
+        amoled_os_lock(&w->lock);
+        w->sending = false;
+        w->sent++;
+        counters_add(&w->counters, &counters);
+        if (w->waiting) {
+            w->waiting = false;
+            amoled_os_sem_give(&w->done);
+        }
+        amoled_os_unlock(&w->lock);
+    }
+}
+
+bool amoled_worker_start(amoled_worker_t *w, amoled_worker_fn_t fn, void *ctx, int core) {
+    memset(w, 0, sizeof(amoled_worker_t));
+    w->fn = fn;
+    w->ctx = ctx;
+    if (!amoled_os_lock_init(&w->lock)) {
+        return false;
+    }
+    if (!amoled_os_sem_init(&w->jobs)) {
+        amoled_os_lock_deinit(&w->lock);
+        return false;
+    }
+    if (!amoled_os_sem_init(&w->done)) {
+        amoled_os_sem_deinit(&w->jobs);
+        amoled_os_lock_deinit(&w->lock);
+        return false;
+    }
+    if (!amoled_os_thread_start(&w->thread, worker_loop, w, core)) {
+        amoled_os_sem_deinit(&w->done);
+        amoled_os_sem_deinit(&w->jobs);
+        amoled_os_lock_deinit(&w->lock);
+        return false;
+    }
+    return true;
+}
+
+// Send what is queued, then end the thread
+void amoled_worker_stop(amoled_worker_t *w) {
+    amoled_os_lock(&w->lock);
+    w->stop = true;
+    amoled_os_unlock(&w->lock);
+    amoled_os_sem_give(&w->jobs);
+    amoled_os_thread_join(&w->thread);
+    amoled_os_sem_deinit(&w->done);
+    amoled_os_sem_deinit(&w->jobs);
+    amoled_os_lock_deinit(&w->lock);
+}
+
+// Drop what is queued, let the area being sent end, then end the thread : used by finalisers,
+// when what the areas point to may already be collected
+void amoled_worker_abort(amoled_worker_t *w) {
+    amoled_os_lock(&w->lock);
+    w->count = 0;
+    amoled_os_unlock(&w->lock);
+    amoled_worker_stop(w);
+}
+
+// Sleep until the worker has sent one more area, called with the lock held and returns with it held
+static void worker_wait(amoled_worker_t *w) {
+    w->waiting = true;
+    w->stalls++;
+    amoled_os_unlock(&w->lock);
+    amoled_os_sem_take(&w->done);
+    amoled_os_lock(&w->lock);
+}
+
+// Queue an area, blocks while the queue is full
+void amoled_worker_push(amoled_worker_t *w, const amoled_area_t *area) {
+    amoled_os_lock(&w->lock);
+    while (w->count == AMOLED_WORKER_QUEUE) {
+        worker_wait(w);
+    }
+    w->queue[(w->head + w->count) % AMOLED_WORKER_QUEUE] = *area;
+    w->count++;
+    amoled_os_unlock(&w->lock);
+    amoled_os_sem_give(&w->jobs);
+}
+
+// True if area overlaps an area queued or being sent, called with the lock held
+static bool worker_holds(amoled_worker_t *w, const amoled_area_t *area) {
+    if (w->sending && area_overlap(&w->current, area)) {
+        return true;
+    }
+    for (uint8_t i = 0; i < w->count; i++) {
+        if (area_overlap(&w->queue[(w->head + i) % AMOLED_WORKER_QUEUE], area)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Blocks until the frame buffer area can be written : no pending area overlaps it
+void amoled_worker_fence(amoled_worker_t *w, const amoled_area_t *area) {
+    amoled_os_lock(&w->lock);
+    while (worker_holds(w, area)) {
+        worker_wait(w);
+    }
+    amoled_os_unlock(&w->lock);
+}
+
+// Blocks until every queued area is sent
+void amoled_worker_drain(amoled_worker_t *w) {
+    amoled_os_lock(&w->lock);
+    while (w->count || w->sending) {
+        worker_wait(w);
+    }
+    amoled_os_unlock(&w->lock);
+}
+
+bool amoled_worker_busy(amoled_worker_t *w) {
+    amoled_os_lock(&w->lock);
+    bool busy = w->count || w->sending;
+    amoled_os_unlock(&w->lock);
+    return busy;
+}
+
+// Add the counters of the areas sent since the last call to counters, and clear them
+void amoled_worker_collect(amoled_worker_t *w, amoled_worker_counters_t *counters) {
+    amoled_os_lock(&w->lock);
+    counters_add(counters, &w->counters);
+    memset(&w->counters, 0, sizeof(w->counters));
+    amoled_os_unlock(&w->lock);
+}
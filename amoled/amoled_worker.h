@@ -0,0 +1,74 @@
+#ifndef __AMOLED_WORKER_H__
+#define __AMOLED_WORKER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "amoled_damage.h"
+#include "amoled_os.h"
+#include "amoled_stats.h"
+
+/*
+Flush worker : a thread consuming a queue of frame buffer areas to send.
+
+The producer (Micropython) pushes the damaged areas and keeps drawing. Before writing an
+area of the frame buffer it calls amoled_worker_fence, which only blocks while a queued or
+in-flight area overlaps it : drawing into untouched regions never waits for the bus.
+Plain C, no Micropython dependency : the send function is given by the caller.
+*/
+
+#define AMOLED_WORKER_QUEUE 16      // queued areas before the producer blocks
+
+// Counters of the send function : it adds to the ones it is given, the worker keeps the totals
+// under its lock until the producer collects them
+typedef struct _amoled_worker_counters_t {
+#if AMOLED_STATS
+    amoled_stats_t stats;
+#endif
+    uint32_t windows;                           // panel windows sent
+    uint64_t bytes_sent;                        // pixel bytes sent
+} amoled_worker_counters_t;
+
+typedef void (*amoled_worker_fn_t)(void *ctx, const amoled_area_t *area, amoled_worker_counters_t *counters);
+
+typedef struct _amoled_worker_t {
+    amoled_os_lock_t lock;                      // protects everything below
+    amoled_os_sem_t jobs;                       // one count per queued area (and one to stop)
+    amoled_os_sem_t done;                       // given when the producer waits and an area was sent
+    amoled_os_thread_t thread;
+
+    amoled_worker_fn_t fn;
+    void *ctx;
+
+    amoled_area_t queue[AMOLED_WORKER_QUEUE];
+    uint8_t head;                               // next area to send
+    uint8_t count;                              // queued areas
+    amoled_area_t current;                      // area being sent
+    bool sending;
+    bool waiting;                               // the producer sleeps on done
+    bool stop;
+
+    // statistics
+    uint32_t sent;                              // areas sent
+    uint32_t stalls;                            // times the producer had to wait
+    amoled_worker_counters_t counters;          // send function counters not collected yet
+} amoled_worker_t;
+
+bool amoled_worker_start(amoled_worker_t *w, amoled_worker_fn_t fn, void *ctx, int core);
+void amoled_worker_stop(amoled_worker_t *w);
+void amoled_worker_abort(amoled_worker_t *w);
+void amoled_worker_push(amoled_worker_t *w, const amoled_area_t *area);
+void amoled_worker_fence(amoled_worker_t *w, const amoled_area_t *area);
+void amoled_worker_drain(amoled_worker_t *w);
+bool amoled_worker_busy(amoled_worker_t *w);
+void amoled_worker_collect(amoled_worker_t *w, amoled_worker_counters_t *counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
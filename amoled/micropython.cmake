@@ -5,6 +5,14 @@
  8 target_sources(usermod_amoled INTERFACE
  9     ${CMAKE_CURRENT_LIST_DIR}/amoled.c
 10     ${CMAKE_CURRENT_LIST_DIR}/amoled_qspi_bus.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_damage.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_dlist.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_os.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_worker.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_blit.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_raster.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_panel_sim.c
+    ${CMAKE_CURRENT_LIST_DIR}/amoled_record_bus.c
 11     ${CMAKE_CURRENT_LIST_DIR}/mpfile/mpfile.c
 12     ${CMAKE_CURRENT_LIST_DIR}/jpg/tjpgd565.c
 13     )
@@ -15,5 +23,10 @@
 18     ${CMAKE_CURRENT_LIST_DIR}
 19     )
 20
+# 128 bits stores of the ESP32-S3 vector unit (PIE) in the span fill kernel
+if(IDF_TARGET STREQUAL "esp32s3")
+    target_compile_definitions(usermod_amoled INTERFACE AMOLED_BLIT_PIE=1)
+endif()
+
 21 # Link our INTERFACE library to the usermod target.
 22 target_link_libraries(usermod INTERFACE usermod_amoled)
@@ -2,7 +2,24 @@ AMOLED_MOD_DIR := $(USERMOD_DIR)
 
 CFLAGS_USERMOD += -I$(AMOLED_MOD_DIR)
 
+# make -C ports/unix USER_C_MODULES=... AMOLED_RECORD_BUS_ONLY=1 builds the RecordBus alone (no ESP-IDF)
+ifeq ($(AMOLED_RECORD_BUS_ONLY),1)
+CFLAGS_USERMOD += -DAMOLED_RECORD_BUS_ONLY
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_panel_sim.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_record_bus.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_os.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_worker.c
+else
 SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled.c
 SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_qspi_bus.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_damage.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_dlist.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_os.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_worker.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_blit.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_raster.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_panel_sim.c
+SRC_USERMOD += $(AMOLED_MOD_DIR)/amoled_record_bus.c
 SRC_USERMOD += $(AMOLED_MOD_DIR)/jpg/tjpgd565.c
 SRC_USERMOD += $(AMOLED_MOD_DIR)/mpfile/mpfile.c
+endif
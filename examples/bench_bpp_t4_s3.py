@@ -0,0 +1,43 @@
+import utime
+import amoled
+from machine import SPI
+import tft_config_t4_s3 as cfg
+
+# Time full screen refreshes for each panel color depth
+# 18 and 24 bpp send 3 bytes per pixel, expanded from the RGB565 frame buffer while refreshing
+
+FRAMES = 20
+
+def bench(bpp):
+    spi = SPI(2, sck=cfg.TFT_SCK, mosi=None, miso=None, polarity=0, phase=0)
+    panel = amoled.QSPIPanel(
+            spi=spi, data=(cfg.TFT_D0, cfg.TFT_D1, cfg.TFT_D2, cfg.TFT_D3),
+            dc=cfg.TFT_D1, cs=cfg.TFT_CS, pclk=80_000_000, width=450, height=600)
+    tft = amoled.AMOLED(panel, type=1, reset=cfg.TFT_RST, bpp=bpp, auto_refresh=False)
+    tft.reset()
+    tft.init()
+    tft.brightness(255)
+
+    # a gradient shows the banding differences
+    width = tft.width()
+    height = tft.height()
+    for y in range(height):
+        tft.hline(0, y, width, tft.colorRGB(y * 255 // height, 128, 255 - y * 255 // height))
+    tft.refresh()
+    tft.reset_stats()
+
+    start = utime.ticks_us()
+    for _ in range(FRAMES):
+        tft.refresh(0, 0, width, height)
+    elapsed = utime.ticks_diff(utime.ticks_us(), start)
+    stats = tft.stats()
+    print("bpp %2d : %6d us/frame, %7d bytes/frame, copy %6d us/frame" % (
+        bpp, elapsed // FRAMES, stats["pixel_bytes"] // FRAMES, stats["copy_us"] // FRAMES))
+    tft.deinit()
+
+def main():
+    cfg.TFT_CDE.value(1)
+    for bpp in (16, 18, 24):
+        bench(bpp)
+
+main()
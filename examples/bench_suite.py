@@ -0,0 +1,125 @@
+import json
+import os
+import sys
+import utime
+import amoled
+import fonts.bench_bitmap as bfont
+import fonts.bench_vector as vfont
+
+# Deterministic benchmark of the drawing primitives, one JSON line per primitive :
+#   {"op": "fill_rect", "platform": "esp32", "version": ..., "bus": "qspi", "ops": 1280, "ops_s": ...,
+#    "mpixel_s": ..., "bus_bytes_op": ...}
+# Every batch of 64 calls replays the same scene (same generator and seed as host/amoled_bench.c, which runs
+# the rendering core on Linux with the same scenes and keys), so results of two firmwares can be compared.
+# mpixel_s counts the pixels sent to the panel, bus_bytes_op the bytes on the QSPI bus per call, 4 bytes
+# of command and address included for each transaction (needs the transfer statistics, see stats()).
+# Results are also appended to OUTPUT.
+
+BUS = "qspi"            # "record" draws through a RecordBus : the driver alone, without the SPI transfers
+JPG = "/bmp/smiley_big.jpg"
+OUTPUT = "bench.jsonl"
+BATCH = 64
+SEED = 12345
+RUN_MS = 1000           # minimum time spent on each primitive
+
+TEXT = "The quick brown fox jumps over"
+STAR = [((20 + 20 * (i % 3)) if i & 1 else 60, 8 * i) for i in range(10)]
+
+_seed = SEED
+
+def rnd(n):
+    global _seed
+    _seed = (_seed * 1103515245 + 12345) & 0xFFFFFFFF
+    return ((_seed >> 16) & 0x7FFF) % n
+
+def scene(width, height):
+    # every call draws the same values in the same order, whatever the primitive uses
+    global _seed
+    _seed = SEED
+    calls = []
+    for _ in range(BATCH):
+        x = rnd(width)
+        y = rnd(height)
+        w = rnd(width - x) + 1
+        h = rnd(height - y) + 1
+        color = rnd(0x10000)
+        calls.append((x, y, w, h, color, rnd(width), rnd(height), rnd(width), rnd(height), rnd(100), rnd(96)))
+    return calls
+
+def display():
+    if BUS == "record":
+        bus = amoled.RecordBus(width=450, height=600)
+        tft = amoled.AMOLED(bus, type=1, bpp=16)
+    else:
+        import tft_config_t4_s3 as cfg
+        cfg.TFT_CDE.value(1)
+        tft = cfg.config()
+        tft.reset()
+    tft.init()
+    tft.rotation(1)         # 600 x 450, as host/amoled_bench.c
+    return tft
+
+def primitives(tft, width, height):
+    return (
+        ("fill",             lambda p: tft.fill(p[4])),
+        ("fill_rect",        lambda p: tft.fill_rect(p[0], p[1], p[2], p[3], p[4])),
+        ("hline",            lambda p: tft.hline(p[0], p[1], p[2], p[4])),
+        ("vline",            lambda p: tft.vline(p[0], p[1], p[3], p[4])),
+        ("line",             lambda p: tft.line(p[0], p[1], p[5], p[6], p[4])),
+        ("rect",             lambda p: tft.rect(p[0], p[1], p[2], p[3], p[4])),
+        ("circle",           lambda p: tft.circle(p[0], p[1], p[9], p[4])),
+        ("fill_circle",      lambda p: tft.fill_circle(p[0], p[1], p[9], p[4])),
+        ("fill_trian",       lambda p: tft.fill_trian(p[0], p[1], p[5], p[6], p[7], p[8], p[4])),
+        ("fill_bubble_rect", lambda p: tft.fill_bubble_rect(p[0], p[1], p[2], p[3], p[4])),
+        ("fill_polygon",     lambda p: tft.fill_polygon(STAR, p[0] % (width - 80), p[1] % (height - 80), p[4])),
+        ("text",             lambda p: tft.text(bfont, TEXT, p[0] % 100, p[1] % (height - 32), p[4], 0)),
+        ("write",            lambda p: tft.write(bfont, bfont.MAP[p[10]], p[0] % (width - 40), p[1] % (height - 32), p[4], 0)),
+        ("draw",             lambda p: tft.draw(vfont, TEXT, p[0] % 100, 20 + p[1] % (height - 40), p[4], 1.0)),
+        ("refresh",          lambda p: tft.refresh(0, 0, width, height)),
+        ("jpg",              lambda p: tft.jpg(JPG, p[0] % 100, p[1] % 100)),
+    )
+
+def run(tft, name, op, calls):
+    tft.reset_stats()
+    count = 0
+    start = utime.ticks_us()
+    while True:
+        for p in calls:
+            op(p)
+        count += len(calls)
+        elapsed = utime.ticks_diff(utime.ticks_us(), start)
+        if elapsed >= RUN_MS * 1000:
+            break
+    tft.wait()
+    stats = tft.stats()
+    result = {
+        "op": name,
+        "platform": sys.platform,
+        "version": os.uname().version,
+        "bus": BUS,
+        "ops": count,
+        "ops_s": count * 1e6 / elapsed,
+        "mpixel_s": None,
+        "bus_bytes_op": None,
+    }
+    if stats:
+        bus_bytes = stats["pixel_bytes"] + stats["param_bytes"] + 4 * (stats["transactions"] + stats["commands"])
+        result["mpixel_s"] = stats["pixel_bytes"] / 2 / elapsed
+        result["bus_bytes_op"] = bus_bytes / count
+    return result
+
+def main():
+    tft = display()
+    width = tft.width()
+    height = tft.height()
+    if (width, height) != (600, 450):
+        print("warning: %d x %d screen, the scenes differ from the host ones" % (width, height))
+    calls = scene(width, height)
+    with open(OUTPUT, "a") as out:
+        for name, op in primitives(tft, width, height):
+            result = json.dumps(run(tft, name, op, calls))
+            print(result)
+            out.write(result + "\n")
+    tft.deinit()
+
+main()
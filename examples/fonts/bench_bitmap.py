@@ -0,0 +1,30 @@
+# Synthetic bitmap fonts of the benchmark suite (examples/bench_suite.py, host/amoled_bench.c)
+# The glyphs are pseudo random bits : only their size matters, and the host benchmark builds the same ones.
+# text() uses WIDTH, HEIGHT, FIRST, LAST and FONT, write() uses HEIGHT, BPP, OFFSET_WIDTH, WIDTHS, OFFSETS, BITMAPS and MAP
+
+_seed = 1
+
+def _rnd(n):
+    global _seed
+    _seed = (_seed * 1103515245 + 12345) & 0xFFFFFFFF
+    return ((_seed >> 16) & 0x7FFF) % n
+
+WIDTH = 16
+HEIGHT = 32
+FIRST = 32
+LAST = 127
+FONT = bytes(_rnd(256) for _ in range(96 * 32 * 2))
+
+BPP = 1
+OFFSET_WIDTH = 2
+MAP = "".join(chr(c) for c in range(32, 128))
+BITMAPS = bytes(_rnd(256) for _ in range(96 * 32 * 32 // 8))
+WIDTHS = bytearray(96)
+OFFSETS = bytearray(96 * 2)
+
+_bit = 0
+for _i in range(96):
+    WIDTHS[_i] = 12 + _rnd(16)
+    OFFSETS[2 * _i] = _bit >> 8
+    OFFSETS[2 * _i + 1] = _bit & 0xFF
+    _bit = (_bit + WIDTHS[_i] * 32) % (8 * len(BITMAPS) - 32 * 32)
@@ -0,0 +1,6 @@
+# Synthetic vector font of the benchmark suite (examples/bench_suite.py, host/amoled_bench.c)
+# Every glyph is the same closed square of 5 points
+
+INDEX = bytes(2 * 96)
+FONT = bytes((5, 0x52 - 8, 0x52 + 8, 0x52 - 6, 0x52 - 6, 0x52 + 6, 0x52 - 6,
+              0x52 + 6, 0x52 + 6, 0x52 - 6, 0x52 + 6, 0x52 - 6, 0x52 - 6))
@@ -0,0 +1,291 @@
+/* Host benchmark of the AMOLED rendering core
+
+Draws fixed pseudo random scenes into a 600 x 450 RGB565 surface (T4-S3 screen in landscape)
+and prints, for each primitive, the calls per second, the pixels sent per second and the bus bytes per call.
+
+The scenes are the ones of examples/bench_suite.py, which runs them on the device : every batch
+of 64 calls replays the same random sequence (same generator, same seed, same draws per call), and
+the fonts are the synthetic ones of examples/fonts/bench_bitmap.py and bench_vector.py.
+After each call the damaged areas are sent as the display auto_refresh does (CASET, RASET and RAMWR
+then RAMWRC for every staging buffer of rows) to the panel model, which counts the bus bytes.
+The panel GRAM must then hold the surface : a difference means a primitive wrote outside
+the area it damaged, and the benchmark fails.
+
+    amoled_bench [-j] [-k] [jpg_file]
+
+-j prints one JSON object per primitive (same keys as bench_suite.py) instead of a table.
+-k benchmarks the RGB565 span fill kernel (amoled_blit_fill16) against the plain pixel loop it replaced,
+   for short and long spans starting on odd and even pixels, and checks both write the same pixels.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "amoled_raster.h"
+#include "amoled_blit.h"
+#include "amoled_panel_sim.h"
+#include "host_fonts.h"
+
+#define WIDTH   600
+#define HEIGHT  450
+#define BATCH   64              // calls of a scene, replayed until RUN_NS
+#define SEED    12345
+#define RUN_NS  200000000LL     // minimum time spent on each primitive
+#define STAGING 16384           // staging buffer of the display (staging_size), a RAMWRC per buffer of rows
+
+static amoled_damage_t damage;
+static amoled_panel_sim_t panel;
+
+static void record_damage(void *ctx, int x, int y, int w, int h) {
+    (void)ctx;
+    amoled_damage_add(&damage, x, y, w, h, WIDTH, HEIGHT);
+}
+
+static void tx_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    uint8_t bufx[4] = { x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF };
+    uint8_t bufy[4] = { y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF };
+
+    amoled_panel_sim_param(&panel, 0x2A, bufx, 4);      // CASET
+    amoled_panel_sim_param(&panel, 0x2B, bufy, 4);      // RASET
+    amoled_panel_sim_param(&panel, 0x2C, NULL, 0);      // RAMWR
+}
+
+// Send the damaged areas as refresh_display does
+static void flush(const amoled_surface_t *s) {
+    static uint16_t staging[STAGING / 2];
+    amoled_area_t a;
+
+    while (amoled_damage_next(&damage, &a, WIDTH, HEIGHT)) {
+        uint16_t cols = a.x1 - a.x0 + 1;
+        uint16_t rows_per_tx = STAGING / (cols * 2);
+
+        tx_window(a.x0, a.y0, a.x1, a.y1);
+        for (uint16_t y = a.y0; y <= a.y1; y += rows_per_tx) {
+            uint16_t rows = (a.y1 - y + 1 < rows_per_tx) ? a.y1 - y + 1 : rows_per_tx;
+
+            for (uint16_t r = 0; r < rows; r++) {
+                memcpy(&staging[r * cols], &s->pixels[(y + r) * WIDTH + a.x0], cols * 2);
+            }
+            amoled_panel_sim_color(&panel, (y == a.y0) ? 0x2C : 0x3C, staging, rows * cols * 2);
+        }
+    }
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static const char *text = "The quick brown fox jumps over";
+
+typedef struct {
+    amoled_jpg_out_t out;       // first, as amoled_jpg_out_fast expects it
+    const uint8_t *data;
+    size_t len;
+    size_t idx;
+} jpg_dev_t;
+
+static unsigned int jpg_in(JDEC *jd, uint8_t *buff, unsigned int nbyte) {
+    jpg_dev_t *dev = (jpg_dev_t *)jd->device;
+
+    if (nbyte > dev->len - dev->idx) {
+        nbyte = dev->len - dev->idx;
+    }
+    if (buff) {
+        memcpy(buff, dev->data + dev->idx, nbyte);
+    }
+    dev->idx += nbyte;
+    return buff ? nbyte : 0;
+}
+
+static uint8_t *jpg_data;
+static size_t jpg_len;
+
+static void jpg_draw(amoled_surface_t *s, int x, int y) {
+    static uint8_t work[3100];
+    static uint16_t picture[WIDTH * HEIGHT];
+    jpg_dev_t dev = { { (uint8_t *)picture, 0, 0, 0, 0, 0 }, jpg_data, jpg_len, 0 };
+    JDEC jdec;
+
+    if ((jd_prepare(&jdec, jpg_in, work, sizeof(work), &dev) != JDR_OK) ||
+        (jdec.width * jdec.height > WIDTH * HEIGHT)) {
+        return;
+    }
+    dev.out.wfbuf = jdec.width;
+    if (jd_decomp(&jdec, amoled_jpg_out_fast, 0) == JDR_OK) {
+        amoled_raster_copy(s, x, y, jdec.width, jdec.height, picture);
+    }
+}
+
+// Span fill of amoled_raster_span before amoled_blit_fill16
+static void fill16_loop(uint16_t *p, uint16_t color, size_t len) {
+    while (len--) {
+        *p++ = color;
+    }
+}
+
+static double span_mpixel_s(void (*fill)(uint16_t *, uint16_t, size_t), uint16_t *p, size_t len) {
+    // called through a volatile pointer, or the compiler inlines the loop and drops all but its last fill
+    void (*volatile call)(uint16_t *, uint16_t, size_t) = fill;
+    int64_t start = now_ns();
+    int64_t elapsed;
+    uint64_t pixels = 0;
+
+    do {
+        for (int i = 0; i < 1024; i++) {
+            call(p, i, len);
+        }
+        pixels += 1024 * len;
+        elapsed = now_ns() - start;
+    } while (elapsed < RUN_NS / 4);
+    return pixels * 1e3 / elapsed;
+}
+
+// Returns false if the kernel and the loop write different pixels
+static bool kernels(void) {
+    static const size_t lens[] = { 1, 2, 3, 7, 16, 33, 100, 600 };
+    static uint16_t buf[2][WIDTH + 16];
+    bool ok = true;
+
+    printf("%-18s %16s %16s %7s\n", "span", "loop Mpixel/s", "fill16 Mpixel/s", "ratio");
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        for (int odd = 0; odd < 2; odd++) {
+            memset(buf, 0xA5, sizeof(buf));
+            fill16_loop(&buf[0][4 + odd], 0x1234, lens[l]);
+            amoled_blit_fill16(&buf[1][4 + odd], 0x1234, lens[l]);
+            ok &= !memcmp(buf[0], buf[1], sizeof(buf[0]));
+
+            double loop = span_mpixel_s(fill16_loop, &buf[0][4 + odd], lens[l]);
+            double fill16 = span_mpixel_s(amoled_blit_fill16, &buf[1][4 + odd], lens[l]);
+            printf("%4zu pixels %-6s %16.1f %16.1f %7.2f\n", lens[l], odd ? "odd" : "even", loop, fill16, fill16 / loop);
+        }
+    }
+    return ok;
+}
+
+static const char *names[] = { "fill", "fill_rect", "hline", "vline", "line", "rect", "circle",
+    "fill_circle", "fill_trian", "fill_bubble_rect", "fill_polygon", "text", "write", "draw", "refresh", "jpg" };
+
+enum { OP_REFRESH = 14, OP_JPG = 15 };
+
+// Returns false if the panel GRAM differs from the surface afterwards
+static bool run(amoled_surface_t *s, int op, bool json) {
+    int64_t start = now_ns();
+    int64_t elapsed;
+    uint32_t calls = 0;
+    amoled_point_t star[10];
+
+    for (int i = 0; i < 10; i++) {
+        star[i].x = (i & 1) ? 20 + 20 * (i % 3) : 60;
+        star[i].y = 8 * i;
+    }
+    amoled_panel_sim_reset_stats(&panel);
+    do {
+        host_seed = SEED;
+        for (int i = 0; i < BATCH; i++) {
+            // every call draws the same values in the same order, whatever the primitive uses
+            uint16_t x = host_rnd(WIDTH);
+            uint16_t y = host_rnd(HEIGHT);
+            uint16_t w = host_rnd(WIDTH - x) + 1;
+            uint16_t h = host_rnd(HEIGHT - y) + 1;
+            uint16_t color = host_rnd(0x10000);
+            uint16_t x1 = host_rnd(WIDTH);
+            uint16_t y1 = host_rnd(HEIGHT);
+            uint16_t x2 = host_rnd(WIDTH);
+            uint16_t y2 = host_rnd(HEIGHT);
+            uint16_t r = host_rnd(100);
+            uint16_t glyph = host_rnd(96);
+
+            switch (op) {
+                case 0:  amoled_raster_fill(s, color, 0, 0, WIDTH, HEIGHT); break;
+                case 1:  amoled_raster_fill_rect(s, x, y, w, h, color); break;
+                case 2:  amoled_raster_hline(s, x, y, w, color); break;
+                case 3:  amoled_raster_vline(s, x, y, h, color); break;
+                case 4:  amoled_raster_line(s, x, y, x1, y1, color); break;
+                case 5:  amoled_raster_rect(s, x, y, w, h, color); break;
+                case 6:  amoled_raster_circle(s, x, y, r, color); break;
+                case 7:  amoled_raster_fill_circle(s, x, y, r, color); break;
+                case 8:  amoled_raster_fill_trian(s, x, y, x1, y1, x2, y2, color); break;
+                case 9:  amoled_raster_fill_bubble_rect(s, x, y, w, h, color); break;
+                case 10: amoled_raster_fill_polygon(s, star, 10, x % (WIDTH - 80), y % (HEIGHT - 80), color); break;
+                case 11: amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), x % 100, y % (HEIGHT - 32), color, 0); break;
+                case 12: amoled_raster_glyph(s, &host_pfont, glyph, x % (WIDTH - 40), y % (HEIGHT - 32), color, 0); break;
+                case 13: amoled_raster_draw(s, host_hershey_index, host_hershey_font, text, x % 100, 20 + y % (HEIGHT - 40), color, 1.0f); break;
+                case OP_REFRESH: amoled_damage_add(&damage, 0, 0, WIDTH, HEIGHT, WIDTH, HEIGHT); break;
+                case OP_JPG: jpg_draw(s, x % 100, y % 100); break;
+            }
+            flush(s);
+        }
+        calls += BATCH;
+        elapsed = now_ns() - start;
+    } while (elapsed < RUN_NS);
+
+    double ops_s = calls * 1e9 / elapsed;
+    double mpixel_s = panel.stats.pixel_bytes / 2 * 1e3 / elapsed;
+    double bus_bytes_op = (double)panel.stats.bus_bytes / calls;
+
+    if (json) {
+        printf("{\"op\": \"%s\", \"platform\": \"host\", \"bus\": \"sim\", \"ops\": %u, \"ops_s\": %.1f, \"mpixel_s\": %.3f, "
+               "\"bus_bytes_op\": %.1f}\n", names[op], calls, ops_s, mpixel_s, bus_bytes_op);
+    } else {
+        printf("%-18s %12.0f calls/s %10.2f Mpixel/s %12.0f bus bytes/call\n", names[op], ops_s, mpixel_s, bus_bytes_op);
+    }
+    return memcmp(panel.gram, s->pixels, panel.gram_size) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    static uint16_t pixels_buf[WIDTH * HEIGHT];
+    static uint16_t gram[WIDTH * HEIGHT];
+    static amoled_panel_sim_log_t log[1];
+    amoled_surface_t s;
+    bool json = false;
+    int ops = OP_JPG;
+    int failed = 0;
+
+    if ((argc > 1) && !strcmp(argv[1], "-j")) {
+        json = true;
+        argc--;
+        argv++;
+    }
+    if ((argc > 1) && !strcmp(argv[1], "-k")) {
+        if (!kernels()) {
+            fprintf(stderr, "fill16: pixels differ from the plain loop\n");
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1) {
+        FILE *f = fopen(argv[1], "rb");
+        if (f == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        fseek(f, 0, SEEK_END);
+        jpg_len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        jpg_data = malloc(jpg_len);
+        if ((jpg_data == NULL) || (fread(jpg_data, 1, jpg_len, f) != jpg_len)) {
+            fprintf(stderr, "%s: read failed\n", argv[1]);
+            return 1;
+        }
+        fclose(f);
+        ops = OP_JPG + 1;
+    }
+
+    host_fonts_init();
+    amoled_damage_init(&damage);
+    amoled_panel_sim_init(&panel, (uint8_t *)gram, sizeof(gram), WIDTH, HEIGHT, log, 1);
+    amoled_surface_init(&s, pixels_buf, WIDTH, HEIGHT, 16);
+    s.damage = record_damage;
+    for (int op = 0; op < ops; op++) {
+        if (!run(&s, op, json)) {
+            fprintf(stderr, "%s: panel GRAM differs from the frame buffer\n", names[op]);
+            failed = 1;
+        }
+    }
+    free(jpg_data);
+    return failed;
+}
@@ -0,0 +1,535 @@
+/* Golden image regression test of the AMOLED rendering core
+
+Renders a corpus of fixed scenes with the primitives the AMOLED object binds (same code, drawn into a
+600 x 450 surface as into the frame buffer), and checks each one against host/golden.txt :
+the FNV-1a hash of its pixels must match. A scene taking more than TIMEOUT_S seconds (endless loop)
+fails too.
+
+Times are stored as costs : the best time over RUNS renders divided by the best time of a fixed
+calibration loop measured in the same run, so goldens recorded on one machine hold on another one.
+The timing check is opt-in : with -t the cost of a scene must stay below the stored one times the tolerance.
+
+    amoled_golden [-u] [-o dir] [-t tolerance] [golden_file]
+
+-u rewrites golden_file with the hashes and costs of this run (after an intended change)
+-o writes every scene to dir/<scene>.ppm, to look at a failing one or compare two builds
+-t checks the costs with this tolerance (1.5 : 50% slower fails), off by default
+*/
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "amoled_raster.h"
+#include "host_fonts.h"
+
+#define WIDTH       600
+#define HEIGHT      450
+#define RUNS        20          // renders of each scene, the best time is kept
+#define SLACK_US    20.0        // timer noise allowed on top of the tolerance
+#define TIMEOUT_S   10
+#define MAX_SCENES  32
+
+#define RED         0xF800
+#define GREEN       0x07E0
+#define BLUE        0x001F
+#define WHITE       0xFFFF
+#define YELLOW      0xFFE0
+#define CYAN        0x07FF
+#define MAGENTA     0xF81F
+
+typedef struct {
+    const char *name;
+    uint8_t pixel_bits;
+    void (*draw)(amoled_surface_t *s);
+} scene_t;
+
+typedef struct {
+    char name[32];
+    uint64_t hash;
+    double us;
+    double cost;                // us in calibration loops
+} golden_t;
+
+static const char *text = "The quick brown fox jumps over";
+static const amoled_point_t star[10] = {
+    { 60, 0 }, { 40, 8 }, { 60, 16 }, { 20, 24 }, { 60, 32 }, { 60, 40 }, { 60, 48 }, { 40, 56 }, { 60, 64 }, { 20, 72 }
+};
+
+/*
+Scenes
+*/
+
+// hline up to and past the right edge : the last column must be drawn
+static void scene_hline_edge(amoled_surface_t *s) {
+    for (int i = 0; i < 20; i++) {
+        amoled_raster_hline(s, 580 + i, 10 + 4 * i, 20, RED);
+        amoled_raster_hline(s, 590 + i / 2, 100 + 4 * i, 100, GREEN);
+    }
+    amoled_raster_hline(s, 0, 200, WIDTH, WHITE);
+    amoled_raster_hline(s, WIDTH - 1, 210, 1, YELLOW);
+    amoled_raster_hline(s, WIDTH, 220, 10, BLUE);
+    amoled_raster_hline(s, 0, HEIGHT - 1, WIDTH, CYAN);
+}
+
+// vline up to and past the bottom edge : the last row must be drawn
+static void scene_vline_edge(amoled_surface_t *s) {
+    for (int i = 0; i < 20; i++) {
+        amoled_raster_vline(s, 10 + 4 * i, 430 + i, 20, RED);
+        amoled_raster_vline(s, 100 + 4 * i, 440 + i / 2, 100, GREEN);
+    }
+    amoled_raster_vline(s, 300, 0, HEIGHT, WHITE);
+    amoled_raster_vline(s, 310, HEIGHT - 1, 1, YELLOW);
+    amoled_raster_vline(s, 320, HEIGHT, 10, BLUE);
+    amoled_raster_vline(s, WIDTH - 1, 0, HEIGHT, CYAN);
+}
+
+// lines with ends off the surface, negative ones included : clipped, no wraparound
+static void scene_line_clip(amoled_surface_t *s) {
+    amoled_raster_line(s, -50, 10, 100, 200, RED);
+    amoled_raster_line(s, 300, 300, 700, -20, GREEN);
+    amoled_raster_line(s, -10, -10, -10, 500, BLUE);
+    amoled_raster_line(s, WIDTH - 1, 0, -WIDTH, HEIGHT - 1, WHITE);
+    amoled_raster_line(s, -30000, 225, 30000, 225, YELLOW);
+    amoled_raster_line(s, 450, -1000, 460, 1000, CYAN);
+    amoled_raster_line(s, 0, HEIGHT - 1, WIDTH - 1, 0, MAGENTA);
+    amoled_raster_line(s, 65535, 10, 10, 65535, WHITE);
+}
+
+static void scene_line_fan(amoled_surface_t *s) {
+    for (int i = 0; i < 64; i++) {
+        uint16_t color = (i * 0x0841) ^ 0xF81F;
+        amoled_raster_line(s, WIDTH / 2, HEIGHT / 2, i * (WIDTH - 1) / 63, 0, color);
+        amoled_raster_line(s, WIDTH / 2, HEIGHT / 2, i * (WIDTH - 1) / 63, HEIGHT - 1, color);
+        amoled_raster_line(s, WIDTH / 2, HEIGHT / 2, 0, i * (HEIGHT - 1) / 63, color);
+        amoled_raster_line(s, WIDTH / 2, HEIGHT / 2, WIDTH - 1, i * (HEIGHT - 1) / 63, color);
+    }
+}
+
+static void scene_rects(amoled_surface_t *s) {
+    amoled_raster_fill_rect(s, 10, 10, 100, 60, RED);
+    amoled_raster_rect(s, 120, 10, 100, 60, GREEN);
+    amoled_raster_rect(s, 230, 10, 1, 60, WHITE);
+    amoled_raster_rect(s, 240, 10, 60, 1, WHITE);
+    amoled_raster_fill_rect(s, WIDTH - 50, HEIGHT - 50, 50, 50, BLUE);
+    amoled_raster_fill_rect(s, WIDTH - 40, 0, 50, 10, YELLOW);
+    amoled_raster_rect(s, 0, 0, WIDTH, HEIGHT, CYAN);
+    amoled_raster_bubble_rect(s, 10, 100, 200, 120, MAGENTA);
+    amoled_raster_fill_bubble_rect(s, 230, 100, 200, 120, GREEN);
+    amoled_raster_fill_bubble_rect(s, 450, 100, 30, 30, RED);
+}
+
+static void scene_circles(amoled_surface_t *s) {
+    amoled_raster_circle(s, 100, 100, 80, RED);
+    amoled_raster_fill_circle(s, 300, 100, 80, GREEN);
+    amoled_raster_fill_circle(s, 500, 300, 0, WHITE);
+    amoled_raster_circle(s, 500, 300, 1, WHITE);
+    amoled_raster_fill_circle(s, 20, 430, 60, BLUE);
+    amoled_raster_circle(s, 580, 20, 60, YELLOW);
+    amoled_raster_fill_circle(s, 300, 300, 120, CYAN);
+    amoled_raster_circle(s, 300, 300, 130, MAGENTA);
+}
+
+static void scene_triangles(amoled_surface_t *s) {
+    amoled_raster_trian(s, 10, 10, 200, 50, 80, 200, RED);
+    amoled_raster_fill_trian(s, 250, 10, 450, 60, 300, 220, GREEN);
+    amoled_raster_fill_trian(s, 10, 300, 200, 300, 100, 300, WHITE);
+    amoled_raster_fill_trian(s, 500, 250, 599, 449, 450, 449, BLUE);
+    amoled_raster_fill_trian(s, 100, 250, 250, 440, 20, 440, YELLOW);
+}
+
+static void scene_polygon(amoled_surface_t *s) {
+    amoled_raster_fill_polygon(s, star, 10, 10, 10, RED);
+    amoled_raster_fill_polygon(s, star, 10, 300, 200, GREEN);
+    amoled_raster_fill_polygon(s, star, 10, WIDTH - 61, HEIGHT - 73, BLUE);
+}
+
+// text stops at the first glyph off the right edge
+static void scene_text(amoled_surface_t *s) {
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 0, 0, WHITE, 0);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 100, 100, YELLOW, BLUE);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 500, 200, RED, 0);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 0, HEIGHT - 32, GREEN, 0);
+}
+
+static void scene_write(amoled_surface_t *s) {
+    int x = 0;
+
+    for (int i = 0; i < 96; i++) {
+        int y = 40 * (i / 24);
+        if (i % 24 == 0) {
+            x = 0;
+        }
+        if (amoled_raster_glyph(s, &host_pfont, i, x, y, WHITE, (i & 1) ? BLUE : 0)) {
+            x += host_pfont.widths[i];
+        }
+    }
+    amoled_raster_glyph(s, &host_pfont, 5, WIDTH - 10, 300, RED, 0);
+}
+
+static void scene_draw(amoled_surface_t *s) {
+    amoled_raster_draw(s, host_hershey_index, host_hershey_font, text, 0, 30, WHITE, 1.0f);
+    amoled_raster_draw(s, host_hershey_index, host_hershey_font, text, 0, 150, YELLOW, 2.0f);
+    amoled_raster_draw(s, host_hershey_index, host_hershey_font, "Edge", WIDTH - 40, 300, RED, 1.5f);
+}
+
+// every primitive with a clip region
+static void scene_clip(amoled_surface_t *s) {
+    s->clip.x0 = 100;
+    s->clip.y0 = 100;
+    s->clip.x1 = 299;
+    s->clip.y1 = 249;
+    amoled_raster_fill(s, BLUE, 0, 0, WIDTH, HEIGHT);
+    amoled_raster_line(s, 0, 0, WIDTH - 1, HEIGHT - 1, WHITE);
+    amoled_raster_hline(s, 0, 150, WIDTH, RED);
+    amoled_raster_vline(s, 200, 0, HEIGHT, GREEN);
+    amoled_raster_fill_circle(s, 100, 100, 60, YELLOW);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 80, 200, WHITE, 0);
+    amoled_raster_fill_polygon(s, star, 10, 260, 200, MAGENTA);
+    amoled_surface_clip_reset(s);
+}
+
+// ring addressed scroll region : logical rows are rotated in memory
+static void scene_scroll(amoled_surface_t *s) {
+    s->scroll_top = 50;
+    s->scroll_rows = 300;
+    s->scroll_offset = 120;
+    amoled_raster_fill_rect(s, 10, 10, 200, 400, RED);
+    amoled_raster_line(s, 0, 0, WIDTH - 1, HEIGHT - 1, WHITE);
+    amoled_raster_fill_circle(s, 400, 200, 100, GREEN);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 0, 330, YELLOW, 0);
+    s->scroll_top = 0;
+    s->scroll_rows = 0;
+    s->scroll_offset = 0;
+}
+
+static uint16_t gradient[64 * 64];
+
+static void scene_blit(amoled_surface_t *s) {
+    amoled_surface_t src;
+    amoled_area_t area;
+
+    amoled_surface_init(&src, gradient, 64, 64, 16);
+    amoled_raster_fill(s, 0x4208, 0, 0, WIDTH, HEIGHT);
+    amoled_raster_blit(s, &src, 10, 10, -1, 255, &area);
+    amoled_raster_blit(s, &src, 100, 10, 0, 255, &area);
+    amoled_raster_blit(s, &src, 200, 10, -1, 128, &area);
+    amoled_raster_blit(s, &src, -20, 200, -1, 255, &area);
+    amoled_raster_blit(s, &src, WIDTH - 30, HEIGHT - 30, -1, 64, &area);
+    amoled_raster_copy(s, 300, 200, 64, 64, gradient);
+    amoled_raster_copy(s, WIDTH - 16, 300, 64, 64, gradient);
+    amoled_raster_copy(s, 400, -32, 64, 64, gradient);
+}
+
+// palette indexes and monochrome surfaces
+static void scene_indexed(amoled_surface_t *s) {
+    amoled_raster_fill(s, 0x03, 0, 0, WIDTH, HEIGHT);
+    amoled_raster_fill_rect(s, 11, 11, 101, 61, 0xE0);
+    amoled_raster_line(s, 0, 0, WIDTH - 1, HEIGHT - 1, 0xFF);
+    amoled_raster_fill_circle(s, 300, 200, 90, 0x1C);
+    amoled_raster_hline(s, 1, 300, WIDTH, 0x0F);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 3, 400, 0xFF, 0x00);
+}
+
+static void scene_mono(amoled_surface_t *s) {
+    amoled_raster_fill_rect(s, 11, 11, 101, 61, 1);
+    amoled_raster_line(s, 0, 0, WIDTH - 1, HEIGHT - 1, 1);
+    amoled_raster_fill_circle(s, 300, 200, 90, 1);
+    amoled_raster_fill_rect(s, 280, 180, 41, 41, 0);
+    amoled_raster_hline(s, 3, 300, WIDTH, 1);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 3, 400, 1, 0);
+    amoled_raster_text(s, &host_font, (const uint8_t *)text, strlen(text), 8, 360, 0, 1);
+}
+
+// the scene of the benchmark : 64 pseudo random calls of every primitive
+static void scene_random(amoled_surface_t *s) {
+    host_seed = 12345;
+    for (int i = 0; i < 64 * 12; i++) {
+        uint16_t x = host_rnd(WIDTH);
+        uint16_t y = host_rnd(HEIGHT);
+        uint16_t w = host_rnd(WIDTH - x) + 1;
+        uint16_t h = host_rnd(HEIGHT - y) + 1;
+        uint16_t color = host_rnd(0x10000);
+        uint16_t x1 = host_rnd(WIDTH);
+        uint16_t y1 = host_rnd(HEIGHT);
+        uint16_t x2 = host_rnd(WIDTH);
+        uint16_t y2 = host_rnd(HEIGHT);
+        uint16_t r = host_rnd(100);
+        uint16_t glyph = host_rnd(96);
+
+        switch (i % 12) {
+            case 0:  amoled_raster_fill_rect(s, x, y, w / 4 + 1, h / 4 + 1, color); break;
+            case 1:  amoled_raster_hline(s, x, y, w, color); break;
+            case 2:  amoled_raster_vline(s, x, y, h, color); break;
+            case 3:  amoled_raster_line(s, x, y, x1, y1, color); break;
+            case 4:  amoled_raster_rect(s, x, y, w, h, color); break;
+            case 5:  amoled_raster_circle(s, x, y, r, color); break;
+            case 6:  amoled_raster_fill_circle(s, x, y, r / 2, color); break;
+            case 7:  amoled_raster_trian(s, x, y, x1, y1, x2, y2, color); break;
+            case 8:  amoled_raster_fill_polygon(s, star, 10, x % (WIDTH - 80), y % (HEIGHT - 80), color); break;
+            case 9:  amoled_raster_text(s, &host_font, (const uint8_t *)text, 6, x % 500, y % (HEIGHT - 32), color, 0); break;
+            case 10: amoled_raster_glyph(s, &host_pfont, glyph, x % (WIDTH - 40), y % (HEIGHT - 32), color, 0); break;
+            case 11: amoled_raster_draw(s, host_hershey_index, host_hershey_font, "Hi", x % 500, 20 + y % (HEIGHT - 40), color, 1.0f); break;
+        }
+    }
+}
+
+static const scene_t scenes[] = {
+    { "hline_edge", 16, scene_hline_edge },
+    { "vline_edge", 16, scene_vline_edge },
+    { "line_clip",  16, scene_line_clip  },
+    { "line_fan",   16, scene_line_fan   },
+    { "rects",      16, scene_rects      },
+    { "circles",    16, scene_circles    },
+    { "triangles",  16, scene_triangles  },
+    { "polygon",    16, scene_polygon    },
+    { "text",       16, scene_text       },
+    { "write",      16, scene_write      },
+    { "draw",       16, scene_draw       },
+    { "clip",       16, scene_clip       },
+    { "scroll",     16, scene_scroll     },
+    { "blit",       16, scene_blit       },
+    { "indexed8",   8,  scene_indexed    },
+    { "mono",       1,  scene_mono       },
+    { "random",     16, scene_random     },
+};
+
+#define SCENES (sizeof(scenes) / sizeof(scenes[0]))
+
+/*
+Checks
+*/
+
+static const char *current;
+
+static void timeout(int sig) {
+    static const char msg[] = "amoled_golden: scene timed out (endless loop ?) : ";
+    (void)sig;
+    (void)!write(2, msg, sizeof(msg) - 1);
+    (void)!write(2, current, strlen(current));
+    (void)!write(2, "\n", 1);
+    _exit(1);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Keeps the calibration read back from being optimised out
+static volatile uint32_t sink;
+
+// Best time of a fixed loop writing and reading back a frame, the unit of the stored costs
+static double calibrate(uint16_t *pixels) {
+    double best = 0;
+
+    for (int run = 0; run < RUNS; run++) {
+        double start = now_us();
+        uint32_t x = 0x12345678;
+        for (size_t i = 0; i < WIDTH * HEIGHT; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            pixels[i] = x;
+        }
+        uint32_t sum = 0;
+        for (size_t i = 0; i < WIDTH * HEIGHT; i++) {
+            sum += pixels[i];
+        }
+        sink = sum;
+        double elapsed = now_us() - start;
+        if ((run == 0) || (elapsed < best)) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static uint64_t fnv1a(const uint8_t *p, size_t len) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    while (len--) {
+        h = (h ^ *p++) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static size_t surface_bytes(const amoled_surface_t *s) {
+    return ((size_t)s->width * s->height * s->pixel_bits + 7) / 8;
+}
+
+// RGB888 of pixel i : RGB565, RRRGGGBB palette indexes or monochrome
+static void pixel_rgb(const amoled_surface_t *s, size_t i, uint8_t *rgb) {
+    const uint8_t *p = (const uint8_t *)s->pixels;
+
+    if (s->pixel_bits == 16) {
+        uint16_t c = s->pixels[i];
+        rgb[0] = ((c >> 11) & 0x1F) * 255 / 31;
+        rgb[1] = ((c >> 5) & 0x3F) * 255 / 63;
+        rgb[2] = (c & 0x1F) * 255 / 31;
+    } else if (s->pixel_bits == 8) {
+        rgb[0] = (p[i] >> 5) * 255 / 7;
+        rgb[1] = ((p[i] >> 2) & 0x07) * 255 / 7;
+        rgb[2] = (p[i] & 0x03) * 255 / 3;
+    } else {
+        uint8_t v = (p[i >> 3] & (0x80 >> (i & 7))) ? 255 : 0;
+        rgb[0] = rgb[1] = rgb[2] = v;
+    }
+}
+
+static int write_ppm(const char *dir, const char *name, const amoled_surface_t *s) {
+    char path[512];
+    uint8_t rgb[3];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", s->width, s->height);
+    for (size_t i = 0; i < (size_t)s->width * s->height; i++) {
+        pixel_rgb(s, i, rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int load_goldens(const char *path, golden_t *goldens) {
+    char line[128];
+    int n = 0;
+    FILE *f = fopen(path, "r");
+
+    if (f == NULL) {
+        return (errno == ENOENT) ? 0 : -1;
+    }
+    while (fgets(line, sizeof(line), f) && (n < MAX_SCENES)) {
+        unsigned long long hash;
+        if ((line[0] == '#') ||
+            (sscanf(line, "%31s %llx %lf", goldens[n].name, &hash, &goldens[n].cost) != 3)) {
+            continue;
+        }
+        goldens[n++].hash = hash;
+    }
+    fclose(f);
+    return n;
+}
+
+static const golden_t *find_golden(const golden_t *goldens, int n, const char *name) {
+    for (int i = 0; i < n; i++) {
+        if (!strcmp(goldens[i].name, name)) {
+            return &goldens[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    static uint16_t pixels[WIDTH * HEIGHT];
+    golden_t goldens[MAX_SCENES];
+    golden_t results[SCENES];
+    const char *golden_path = "host/golden.txt";
+    const char *ppm_dir = NULL;
+    double tolerance = 0;
+    bool update = false;
+    int failed = 0;
+    int opt;
+    int n;
+
+    while ((opt = getopt(argc, argv, "uo:t:")) != -1) {
+        switch (opt) {
+            case 'u': update = true; break;
+            case 'o': ppm_dir = optarg; break;
+            case 't': tolerance = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-u] [-o dir] [-t tolerance] [golden_file]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind < argc) {
+        golden_path = argv[optind];
+    }
+    n = load_goldens(golden_path, goldens);
+    if (n < 0) {
+        perror(golden_path);
+        return 2;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);     // the lines printed before a timeout must not be lost
+    signal(SIGALRM, timeout);
+    host_fonts_init();
+    for (int g = 0; g < 64 * 64; g++) {
+        gradient[g] = ((g % 64 / 2) << 11) | ((g / 64) << 5) | ((g % 64 + g / 64) / 4);
+    }
+    double unit = calibrate(pixels);
+    double slack = SLACK_US / unit;
+    printf("%-12s %16s %10.1f us\n", "calibration", "", unit);
+
+    for (size_t i = 0; i < SCENES; i++) {
+        const scene_t *sc = &scenes[i];
+        amoled_surface_t s;
+        double best = 0;
+
+        current = sc->name;
+        alarm(TIMEOUT_S);
+        amoled_surface_init(&s, pixels, WIDTH, HEIGHT, sc->pixel_bits);
+        for (int run = 0; run < RUNS; run++) {
+            memset(pixels, 0, sizeof(pixels));
+            double start = now_us();
+            sc->draw(&s);
+            double elapsed = now_us() - start;
+            if ((run == 0) || (elapsed < best)) {
+                best = elapsed;
+            }
+        }
+        alarm(0);
+
+        golden_t *r = &results[i];
+        snprintf(r->name, sizeof(r->name), "%s", sc->name);
+        r->hash = fnv1a((const uint8_t *)pixels, surface_bytes(&s));
+        r->us = best;
+        r->cost = best / unit;
+        if (ppm_dir && write_ppm(ppm_dir, sc->name, &s)) {
+            failed = 1;
+        }
+        printf("%-12s %016llx %10.1f us %8.4f", r->name, (unsigned long long)r->hash, r->us, r->cost);
+        if (update) {
+            printf("\n");
+            continue;
+        }
+
+        const golden_t *g = find_golden(goldens, n, sc->name);
+        if (g == NULL) {
+            printf("  NO GOLDEN\n");
+            failed = 1;
+        } else if (g->hash != r->hash) {
+            printf("  IMAGE DIFFERS (golden %016llx)\n", (unsigned long long)g->hash);
+            failed = 1;
+        } else if ((tolerance > 0) && (r->cost > g->cost * tolerance + slack)) {
+            printf("  SLOWER (golden %.4f)\n", g->cost);
+            failed = 1;
+        } else {
+            printf("  ok\n");
+        }
+    }
+
+    if (update) {
+        FILE *f = fopen(golden_path, "w");
+        if (f == NULL) {
+            perror(golden_path);
+            return 2;
+        }
+        fprintf(f, "# amoled_golden : scene, FNV-1a 64 of its pixels, best render time in calibration loops\n");
+        for (size_t i = 0; i < SCENES; i++) {
+            fprintf(f, "%s %016llx %.4f\n", results[i].name, (unsigned long long)results[i].hash, results[i].cost);
+        }
+        fclose(f);
+    }
+    return failed;
+}
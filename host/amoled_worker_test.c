@@ -0,0 +1,336 @@
+/* Flush worker test
+
+Runs amoled_worker.c over the pthread half of amoled_os.c with a send function the test holds :
+an area is only sent once the test lets it through, so what is queued, in flight or sent is known
+when push, fence, drain, abort and stop are called. A call blocked for more than TIMEOUT_S seconds
+(lost wake up, deadlock) fails the test.
+
+    amoled_worker_test
+*/
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "amoled_worker.h"
+
+#define TIMEOUT_S   10
+#define DELAY_MS    50          // time given to a call to block before the areas it waits for are sent
+#define MAX_SENT    64
+
+// Send function state : the worker blocks in send() until the test allows the next area
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int allowed;                // areas send() may still let through, -1 : no limit
+    int entered;                // areas send() was called with
+    int sent;                   // areas send() returned from
+    amoled_area_t order[MAX_SENT];
+} sender_t;
+
+typedef struct {
+    sender_t *sender;
+    int n;
+} release_t;
+
+static const char *current;
+
+static void timeout(int sig) {
+    static const char msg[] = "amoled_worker_test: blocked (lost wake up ?) : ";
+    (void)sig;
+    (void)!write(2, msg, sizeof(msg) - 1);
+    (void)!write(2, current, strlen(current));
+    (void)!write(2, "\n", 1);
+    _exit(1);
+}
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%-28s FAILED line %d : %s\n", current, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+static amoled_area_t area(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    amoled_area_t a = { x0, y0, x1, y1 };
+    return a;
+}
+
+static bool area_equal(const amoled_area_t *a, const amoled_area_t *b) {
+    return (a->x0 == b->x0) && (a->y0 == b->y0) && (a->x1 == b->x1) && (a->y1 == b->y1);
+}
+
+static void sender_send(void *ctx, const amoled_area_t *a, amoled_worker_counters_t *counters) {
+    sender_t *s = (sender_t *)ctx;
+
+    pthread_mutex_lock(&s->mutex);
+    s->entered++;
+    pthread_cond_broadcast(&s->cond);
+    while (s->allowed == 0) {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    if (s->allowed > 0) {
+        s->allowed--;
+    }
+    if (s->sent < MAX_SENT) {
+        s->order[s->sent] = *a;
+    }
+    s->sent++;
+    pthread_mutex_unlock(&s->mutex);
+
+    counters->windows++;
+    counters->bytes_sent += amoled_area_pixels(a) * 2;
+}
+
+static void sender_init(sender_t *s, int allowed) {
+    memset(s, 0, sizeof(sender_t));
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->allowed = allowed;
+}
+
+static int sender_sent(sender_t *s) {
+    pthread_mutex_lock(&s->mutex);
+    int sent = s->sent;
+    pthread_mutex_unlock(&s->mutex);
+    return sent;
+}
+
+// Let n more areas through, all of them if n < 0
+static void sender_release(sender_t *s, int n) {
+    pthread_mutex_lock(&s->mutex);
+    s->allowed = (n < 0) ? -1 : s->allowed + n;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+}
+
+// Wait until the worker is in send() with its n-th area
+static void sender_entered(sender_t *s, int n) {
+    pthread_mutex_lock(&s->mutex);
+    while (s->entered < n) {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    pthread_mutex_unlock(&s->mutex);
+}
+
+static void *release_thread(void *arg) {
+    release_t *r = (release_t *)arg;
+
+    usleep(DELAY_MS * 1000);
+    sender_release(r->sender, r->n);
+    return NULL;
+}
+
+// Release n areas after DELAY_MS, from another thread : the caller can block meanwhile
+static void release_later(pthread_t *thread, release_t *r, sender_t *s, int n) {
+    r->sender = s;
+    r->n = n;
+    CHECK(pthread_create(thread, NULL, release_thread, r) == 0);
+}
+
+static void start(amoled_worker_t *w, sender_t *s, int allowed) {
+    sender_init(s, allowed);
+    CHECK(amoled_worker_start(w, sender_send, s, 0));
+}
+
+/*
+Tests
+*/
+
+// Areas are sent in push order, drain returns once the last one is out and the counters are handed over once
+static void test_push_drain(void) {
+    amoled_worker_t w;
+    sender_t s;
+    amoled_worker_counters_t counters;
+    const amoled_area_t areas[3] = { area(0, 0, 9, 9), area(20, 0, 29, 19), area(0, 20, 99, 21) };
+
+    start(&w, &s, -1);
+    for (int i = 0; i < 3; i++) {
+        amoled_worker_push(&w, &areas[i]);
+    }
+    amoled_worker_drain(&w);
+    CHECK(!amoled_worker_busy(&w));
+    CHECK(sender_sent(&s) == 3);
+    for (int i = 0; i < 3; i++) {
+        CHECK(area_equal(&s.order[i], &areas[i]));
+    }
+
+    memset(&counters, 0, sizeof(counters));
+    amoled_worker_collect(&w, &counters);
+    CHECK(counters.windows == 3);
+    CHECK(counters.bytes_sent == (100 + 200 + 200) * 2);
+    memset(&counters, 0, sizeof(counters));
+    amoled_worker_collect(&w, &counters);
+    CHECK(counters.windows == 0);
+    CHECK(counters.bytes_sent == 0);
+    amoled_worker_stop(&w);
+}
+
+// A full queue blocks push until the worker takes an area
+static void test_push_full(void) {
+    amoled_worker_t w;
+    sender_t s;
+    pthread_t thread;
+    release_t r;
+    amoled_area_t a = area(0, 0, 1, 1);
+    int n = AMOLED_WORKER_QUEUE + 3;
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    release_later(&thread, &r, &s, -1);
+    for (int i = 1; i < n; i++) {
+        amoled_worker_push(&w, &a);
+    }
+    CHECK(sender_sent(&s) > 0);
+    CHECK(w.stalls > 0);
+    amoled_worker_drain(&w);
+    CHECK(sender_sent(&s) == n);
+    pthread_join(thread, NULL);
+    amoled_worker_stop(&w);
+}
+
+// Writing an area that no queued nor in flight area overlaps never waits for the bus
+static void test_fence_disjoint(void) {
+    amoled_worker_t w;
+    sender_t s;
+    amoled_area_t a = area(0, 0, 99, 9);
+    amoled_area_t b = area(0, 20, 99, 29);
+    amoled_area_t c = area(0, 10, 99, 19);      // between a and b, touching neither
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    amoled_worker_push(&w, &b);
+    amoled_worker_fence(&w, &c);
+    CHECK(sender_sent(&s) == 0);
+    CHECK(amoled_worker_busy(&w));
+    CHECK(w.stalls == 0);
+    sender_release(&s, -1);
+    amoled_worker_drain(&w);
+    CHECK(sender_sent(&s) == 2);
+    amoled_worker_stop(&w);
+}
+
+// Writing the area being sent waits for it, not for the areas queued after it
+static void test_fence_sending(void) {
+    amoled_worker_t w;
+    sender_t s;
+    pthread_t thread;
+    release_t r;
+    amoled_area_t a = area(0, 0, 99, 9);
+    amoled_area_t b = area(0, 20, 99, 29);
+    amoled_area_t c = area(50, 8, 51, 9);       // last rows of a
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    amoled_worker_push(&w, &b);
+    release_later(&thread, &r, &s, 1);
+    amoled_worker_fence(&w, &c);
+    CHECK(sender_sent(&s) == 1);
+    CHECK(area_equal(&s.order[0], &a));
+    CHECK(w.stalls > 0);
+    pthread_join(thread, NULL);
+    sender_release(&s, -1);
+    amoled_worker_drain(&w);
+    CHECK(sender_sent(&s) == 2);
+    amoled_worker_stop(&w);
+}
+
+// Writing a queued area waits until it is sent, so after the ones queued before it
+static void test_fence_queued(void) {
+    amoled_worker_t w;
+    sender_t s;
+    pthread_t thread;
+    release_t r;
+    amoled_area_t a = area(0, 0, 99, 9);
+    amoled_area_t b = area(0, 20, 99, 29);
+    amoled_area_t c = area(0, 40, 99, 49);
+    amoled_area_t d = area(98, 28, 99, 29);     // corner of b only
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    amoled_worker_push(&w, &b);
+    amoled_worker_push(&w, &c);
+    release_later(&thread, &r, &s, 2);
+    amoled_worker_fence(&w, &d);
+    CHECK(sender_sent(&s) == 2);
+    CHECK(area_equal(&s.order[1], &b));
+    pthread_join(thread, NULL);
+    sender_release(&s, -1);
+    amoled_worker_drain(&w);
+    CHECK(sender_sent(&s) == 3);
+    amoled_worker_stop(&w);
+}
+
+// stop sends what is queued before the thread ends
+static void test_stop(void) {
+    amoled_worker_t w;
+    sender_t s;
+    pthread_t thread;
+    release_t r;
+    amoled_area_t a = area(0, 0, 9, 9);
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    amoled_worker_push(&w, &a);
+    amoled_worker_push(&w, &a);
+    release_later(&thread, &r, &s, -1);
+    amoled_worker_stop(&w);
+    CHECK(sender_sent(&s) == 3);
+    pthread_join(thread, NULL);
+}
+
+// abort lets the area in flight end but drops the queued ones : they are never sent
+static void test_abort(void) {
+    amoled_worker_t w;
+    sender_t s;
+    pthread_t thread;
+    release_t r;
+    amoled_area_t a = area(0, 0, 9, 9);
+    amoled_area_t b = area(10, 0, 19, 9);
+
+    start(&w, &s, 0);
+    amoled_worker_push(&w, &a);
+    sender_entered(&s, 1);
+    amoled_worker_push(&w, &b);
+    amoled_worker_push(&w, &b);
+    release_later(&thread, &r, &s, -1);
+    amoled_worker_abort(&w);
+    CHECK(sender_sent(&s) == 1);
+    CHECK(area_equal(&s.order[0], &a));
+    pthread_join(thread, NULL);
+}
+
+static const struct {
+    const char *name;
+    void (*run)(void);
+} tests[] = {
+    { "push_drain",     test_push_drain },
+    { "push_full",      test_push_full },
+    { "fence_disjoint", test_fence_disjoint },
+    { "fence_sending",  test_fence_sending },
+    { "fence_queued",   test_fence_queued },
+    { "stop",           test_stop },
+    { "abort",          test_abort },
+};
+
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);     // the lines printed before a timeout must not be lost
+    signal(SIGALRM, timeout);
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        current = tests[i].name;
+        alarm(TIMEOUT_S);
+        tests[i].run();
+        alarm(0);
+        printf("%-28s ok\n", current);
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Compare two benchmark results (JSON lines of examples/bench_suite.py or amoled_bench -j)
+
+    bench_compare.py old.jsonl new.jsonl
+
+Prints, for each primitive found in both, the ops/s ratio new / old and the bus bytes per call of both.
+When a file holds several runs of a primitive, the last one is used.
+"""
+
+import json
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("{"):
+                r = json.loads(line)
+                results[r["op"]] = r
+    return results
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    old = load(sys.argv[1])
+    new = load(sys.argv[2])
+    print("%-18s %12s %12s %7s %14s %14s" % ("op", "old ops/s", "new ops/s", "ratio", "old bytes/op", "new bytes/op"))
+    for op, n in new.items():
+        o = old.get(op)
+        if o is None:
+            continue
+        ratio = n["ops_s"] / o["ops_s"] if o["ops_s"] else float("nan")
+        print("%-18s %12.1f %12.1f %7.2f %14s %14s" % (op, o["ops_s"], n["ops_s"], ratio,
+              o.get("bus_bytes_op"), n.get("bus_bytes_op")))
+
+
+if __name__ == "__main__":
+    main()
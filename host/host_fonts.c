@@ -0,0 +1,40 @@
+/* Synthetic fonts and random generator of the host programs */
+
+#include "host_fonts.h"
+
+uint32_t host_seed;
+
+static uint8_t font_data[96 * 32 * 2];
+static uint8_t pfont_bitmaps[96 * 32 * 32 / 8];
+static uint8_t pfont_widths[96];
+static uint8_t pfont_offsets[96 * 2];
+
+const amoled_font_t host_font = { font_data, 16, 32, 32, 127 };
+const amoled_pfont_t host_pfont = { pfont_bitmaps, pfont_widths, pfont_offsets, 2, 32, 1, NULL, 0, 0 };
+
+const uint8_t host_hershey_index[2 * 96] = { 0 };
+const int8_t host_hershey_font[] = { 5, 0x52 - 8, 0x52 + 8, 0x52 - 6, 0x52 - 6, 0x52 + 6, 0x52 - 6,
+    0x52 + 6, 0x52 + 6, 0x52 - 6, 0x52 + 6, 0x52 - 6, 0x52 - 6 };
+
+uint32_t host_rnd(uint32_t n) {
+    host_seed = host_seed * 1103515245 + 12345;
+    return ((host_seed >> 16) & 0x7FFF) % n;
+}
+
+void host_fonts_init(void) {
+    uint32_t bit = 0;
+
+    host_seed = 1;
+    for (size_t i = 0; i < sizeof(font_data); i++) {
+        font_data[i] = host_rnd(256);
+    }
+    for (size_t i = 0; i < sizeof(pfont_bitmaps); i++) {
+        pfont_bitmaps[i] = host_rnd(256);
+    }
+    for (int i = 0; i < 96; i++) {
+        pfont_widths[i] = 12 + host_rnd(16);
+        pfont_offsets[2 * i] = bit >> 8;
+        pfont_offsets[2 * i + 1] = bit & 0xFF;
+        bit = (bit + pfont_widths[i] * 32) % (8 * sizeof(pfont_bitmaps) - 32 * 32);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef __HOST_FONTS_H__
+#define __HOST_FONTS_H__
+
+#include <stdint.h>
+
+#include "amoled_raster.h"
+
+/*
+Synthetic fonts and random generator of the host programs (amoled_bench, amoled_golden).
+
+Same generator, seeds and fonts as examples/bench_suite.py and examples/fonts/bench_bitmap.py,
+bench_vector.py : the glyphs are pseudo random bits, only their size matters.
+*/
+
+extern uint32_t host_seed;
+
+extern const amoled_font_t host_font;           // text() : 16 x 32, characters 32 to 127
+extern const amoled_pfont_t host_pfont;         // write() : 96 glyphs 12 to 27 x 32, 1 bpp
+extern const uint8_t host_hershey_index[];      // draw() : every glyph is the same closed square
+extern const int8_t host_hershey_font[];
+
+uint32_t host_rnd(uint32_t n);
+void host_fonts_init(void);
+
+#endif